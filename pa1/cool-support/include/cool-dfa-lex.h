@@ -0,0 +1,87 @@
+// -*-Mode: C++;-*-
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef _COOL_DFA_LEX_H_
+#define _COOL_DFA_LEX_H_
+
+//////////////////////////////////////////////////////////////////////
+//
+//  cool-dfa-lex.h
+//
+//  The hand-written scanner in cool-dfa-lex.cc.  All of a scanner's
+//  state, including its line number and the value of the last token,
+//  is in a DfaScanner, so several can run at once on different threads.
+//  They share only the string tables, which lock while adding.
+//
+//  cool_dfa_lex_begin, cool_dfa_yylex and cool_dfa_lex_end drive one
+//  DfaScanner through curr_lineno and cool_yylval, as the flex scanner
+//  does.  dfa_lex_files scans several files in parallel.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <vector>
+#include "cool-parse.h"
+
+class DfaScanner {
+private:
+  enum { MAX_STR_CONST = 1025 };        // as in cool.flex
+
+  const char *cur;                      // the rest of the input
+  const char *input_end;
+  char *mapped;                         // the input, if it is mapped
+  size_t mapped_size;
+  char *owned;                          // the input, if it was read in
+
+  // State that outlives a single token, as in the flex scanner
+  enum { INITIAL, ONE_LINE_COMMENT } start;
+  int lp_star_count;
+
+  char string_buf[MAX_STR_CONST];
+
+  int error(const char *msg);
+  int string_constant(const char *&p);
+  int line_comment(const char *&p);
+  int comment(const char *&p);
+
+public:
+  int lineno;           // the current line; set it before scanning
+  YYSTYPE value;        // the value of the token lex() last returned
+
+  DfaScanner();
+  ~DfaScanner() { end(); }
+
+  // Scan f, which is mapped if it is a regular file and read in
+  // otherwise.  Returns 0 if it can be neither.
+  int begin(FILE *f);
+  // Release the input.
+  void end();
+  // The next token, or 0 at the end of the input.
+  int lex();
+};
+
+int cool_dfa_lex_begin(FILE *f);
+int cool_dfa_yylex();
+void cool_dfa_lex_end();
+
+struct CoolToken {
+  int token;
+  int lineno;           // the line number after the token was scanned
+  YYSTYPE value;
+};
+
+//
+// Scan the nfiles files named in files on up to threads threads, each
+// file with a fresh DfaScanner, appending the tokens of files[i] to
+// tokens[i].  Returns the index of the first file that could not be
+// opened, or nfiles if all of them were scanned.  The symbols entered
+// are numbered as if the files had been scanned one after another.
+//
+int dfa_lex_files(int nfiles, char **files, int threads,
+                  std::vector<CoolToken> *tokens);
+
+#endif
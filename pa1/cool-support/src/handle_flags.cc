@@ -6,9 +6,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "cool-io.h"
 #include <unistd.h>
 #include "cgen_gc.h"
+#include "phase-timer.h"
 
 //
 // coolc provides a debugging switch for each phase of the compiler,
@@ -27,6 +29,13 @@ extern int cool_yydebug;        // for the parser
        int VERBOSE_ERRORS;      // for the parser; prints verbose errors
        int semant_debug;        // for semantic analysis
        int cgen_debug;          // for code gen
+       int binary_ast;          // for semant; write the AST in binary form
+       int dfa_lexer;           // for the lexer; use the hand-written scanner
+       int parallel_jobs;       // for the lexer, parser and semant; threads
+       char *cache_dir;         // for semant and cgen; see class-cache.h
+       int dump_tokens;         // for coolc; write out the intermediate
+       int dump_ast;            //   forms the separate phases pass on
+       int dump_typed_ast;      //   (see coolc.cc)
        bool disable_reg_alloc;  // Don't do register allocation
 
        int cgen_optimize;       // optimize switch for code generator 
@@ -51,9 +60,16 @@ void handle_flags(int argc, char *argv[]) {
   cgen_debug = 0;
   cgen_optimize = 0;
   disable_reg_alloc = 0;
+  binary_ast = 0;
+  dfa_lexer = 0;
+  parallel_jobs = 0;
+  cache_dir = NULL;
+  dump_tokens = 0;
+  dump_ast = 0;
+  dump_typed_ast = 0;
   
 
-  while ((c = getopt(argc, argv, "lpscvrOo:gtT")) != -1) {
+  while ((c = getopt(argc, argv, "lpscvrbdj:C:f:Oo:gtT")) != -1) {
     switch (c) {
 #ifdef DEBUG
     case 'l':
@@ -96,6 +112,38 @@ void handle_flags(int argc, char *argv[]) {
     case 'o':  // set the name of the output file
       out_filename = optarg;
       break;
+    case 'b':  // write the AST in binary form (see ast-binary.h)
+      binary_ast = 1;
+      break;
+    case 'd':  // scan with cool-dfa-lex.cc rather than the flex scanner
+      dfa_lexer = 1;
+      break;
+    case 'j':  // lex or parse the input files, or type check the
+               // classes, on this many threads; for the lexer, implies -d
+      dfa_lexer = 1;
+      parallel_jobs = atoi(optarg);
+      if (parallel_jobs < 1)
+        unknownopt = 1;
+      break;
+    case 'C':  // keep per-class results in this directory and reuse them
+      cache_dir = optarg;
+      break;
+    case 'f':  // -ftime-report: print the time and memory of each phase;
+               // -ftime-trace=file: write them as a Chrome trace;
+               // -fdump-tokens, -fdump-ast, -fdump-typed-ast: see coolc.cc
+      if (strcmp(optarg, "time-report") == 0)
+        phase_timer_enable(true, NULL);
+      else if (strncmp(optarg, "time-trace=", 11) == 0 && optarg[11] != '\0')
+        phase_timer_enable(false, optarg + 11);
+      else if (strcmp(optarg, "dump-tokens") == 0)
+        dump_tokens = 1;
+      else if (strcmp(optarg, "dump-ast") == 0)
+        dump_ast = 1;
+      else if (strcmp(optarg, "dump-typed-ast") == 0)
+        dump_typed_ast = 1;
+      else
+        unknownopt = 1;
+      break;
     case 'O':  // enable optimization
       cgen_optimize = 1;
       break;
@@ -111,9 +159,11 @@ void handle_flags(int argc, char *argv[]) {
   if (unknownopt) {
       cerr << "usage: " << argv[0] << 
 #ifdef DEBUG
-	  " [-lvpscOgtr -o outname] [input-files]\n";
+	  " [-lvpscbdOgtr -j threads -C cachedir -ftime-report -ftime-trace=file\n"
+	  "   -fdump-tokens -fdump-ast -fdump-typed-ast -o outname] [input-files]\n";
 #else
-      " [-Ogt -o outname] [input-files]\n";
+      " [-bdOgt -j threads -C cachedir -ftime-report -ftime-trace=file\n"
+      "   -fdump-tokens -fdump-ast -fdump-typed-ast -o outname] [input-files]\n";
 #endif
       exit(1);
   }
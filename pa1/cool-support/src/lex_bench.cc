@@ -0,0 +1,182 @@
+//
+// lex_bench.cc
+//
+// Measures how fast the Cool lexer tokenizes a large source file, once
+// reading it through YY_INPUT (fread into flex's buffer), once scanning
+// it in place with cool_lex_map and once with the hand-written scanner
+// in cool-dfa-lex.cc, and reports tokens and MB per second for each.
+//
+// Unless a file is given, a synthetic program of the requested size is
+// written to /tmp/lex_bench.cl first.  The file is scanned once before
+// timing so that all runs find it in the page cache and all of its
+// identifiers and constants already interned.
+//
+// It then measures how parallel scanning scales: up to 32 MB of the same
+// program, split into PARTS files, is scanned by dfa_lex_files on 1, 2,
+// 4, ... threads, up to the number of hardware threads or the number
+// given.
+//
+// usage: lex_bench [megabytes [file [threads]]]
+//
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <thread>
+#include "cool-parse.h"
+#include "cool-dfa-lex.h"
+#include "utilities.h"
+
+int curr_lineno;
+FILE *fin;
+YYSTYPE cool_yylval;           // Not compiled with parser, so must define this.
+
+extern int yy_flex_debug;
+extern int cool_yylex();
+extern int cool_lex_map(FILE *f);
+extern void cool_lex_unmap();
+
+enum scan_mode { FREAD, MMAP, DFA };
+static const char *mode_name[] = { "fread", "mmap ", "dfa  " };
+
+#define PARTS 32
+#define MAX_PARALLEL_MB 32
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// A class whose features exercise every kind of token: keywords in mixed
+// case, identifiers, integers, strings with escapes, both kinds of
+// comments and all the operators.
+static void write_program(const char *path, long bytes)
+{
+  FILE *f = fopen(path, "w");
+  if (f == NULL) {
+    fprintf(stderr, "Cannot create %s\n", path);
+    exit(1);
+  }
+  for (long n = 0; ftell(f) < bytes; n++) {
+    int k = n % 1000;
+    fprintf(f,
+      "(* class number %ld *)\n"
+      "class C%d inherits IO {\n"
+      "  count%d : Int <- %d;\n"
+      "  name : String <- \"class %d\\tof the \\\"bench\\\"\\n\";\n"
+      "  step(x : Int, flag : Bool) : Int {  -- one step\n"
+      "    if flag = true then\n"
+      "      let y : Int <- x * 3 + count%d / 2 in\n"
+      "        { count%d <- y - ~x; out_string(name); y; }\n"
+      "    Else\n"
+      "      while not x <= 0 LOOP x <- x - 1 pool\n"
+      "    fi\n"
+      "  };\n"
+      "  kind(o : Object) : String {\n"
+      "    case o of i : Int => \"int\"; s : String => \"string\"; "
+      "o2 : Object => \"other\"; esac\n"
+      "  };\n"
+      "  fresh() : SELF_TYPE { if isvoid self then new SELF_TYPE else "
+      "self@IO.copy() fi };\n"
+      "};\n\n",
+      n, k, k, k, k, k, k);
+  }
+  fclose(f);
+}
+
+static long scan(const char *path, scan_mode mode)
+{
+  fin = fopen(path, "r");
+  if (fin == NULL) {
+    fprintf(stderr, "Cannot open %s\n", path);
+    exit(1);
+  }
+  if ((mode == MMAP && !cool_lex_map(fin)) ||
+      (mode == DFA && !cool_dfa_lex_begin(fin))) {
+    fprintf(stderr, "Cannot map %s\n", path);
+    exit(1);
+  }
+  curr_lineno = 1;
+  long tokens = 0;
+  if (mode == DFA) {
+    while (cool_dfa_yylex() != 0)
+      tokens++;
+    cool_dfa_lex_end();
+  } else {
+    while (cool_yylex() != 0)
+      tokens++;
+    if (mode == MMAP)
+      cool_lex_unmap();
+  }
+  fclose(fin);
+  return tokens;
+}
+
+static long scan_parallel(char **parts, int threads)
+{
+  std::vector<CoolToken> tokens[PARTS];
+  if (dfa_lex_files(PARTS, parts, threads, tokens) < PARTS) {
+    fprintf(stderr, "Cannot open the parts\n");
+    exit(1);
+  }
+  long n = 0;
+  for (int i = 0; i < PARTS; i++)
+    n += tokens[i].size();
+  return n;
+}
+
+int main(int argc, char *argv[]) {
+  long mb = argc > 1 ? atol(argv[1]) : 100;
+  const char *path = argc > 2 ? argv[2] : "/tmp/lex_bench.cl";
+  struct stat st;
+
+  yy_flex_debug = 0;
+  if (argc <= 2 || stat(path, &st) != 0) {
+    write_program(path, mb << 20);
+    stat(path, &st);
+  }
+  double size = st.st_size / 1e6;
+
+  scan(path, FREAD);
+  for (int mode = FREAD; mode <= DFA; mode++) {
+    double start = seconds();
+    long tokens = scan(path, (scan_mode) mode);
+    double elapsed = seconds() - start;
+    printf("%s: %.1f MB, %ld tokens in %.3f s, %.2f M tokens/s, %.1f MB/s\n",
+           mode_name[mode], size, tokens, elapsed,
+           tokens / elapsed / 1e6, size / elapsed);
+  }
+
+  int max_threads = argc > 3 ? atoi(argv[3]) : std::thread::hardware_concurrency();
+  if (max_threads < 1)
+    max_threads = 1;
+  long part_bytes = (mb < MAX_PARALLEL_MB ? mb : MAX_PARALLEL_MB) * (1 << 20) / PARTS;
+  char *parts[PARTS];
+  double part_size = 0;
+  for (int i = 0; i < PARTS; i++) {
+    parts[i] = new char[64];
+    snprintf(parts[i], 64, "/tmp/lex_bench.part%02d.cl", i);
+    write_program(parts[i], part_bytes);
+    stat(parts[i], &st);
+    part_size += st.st_size / 1e6;
+  }
+
+  scan_parallel(parts, 1);
+  double base = 0;
+  for (int threads = 1; ; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+    double start = seconds();
+    long tokens = scan_parallel(parts, threads);
+    double elapsed = seconds() - start;
+    if (threads == 1)
+      base = elapsed;
+    printf("%2d threads: %.1f MB in %d files, %ld tokens in %.3f s, "
+           "%.2f M tokens/s, speedup %.2f\n",
+           threads, part_size, PARTS, tokens, elapsed,
+           tokens / elapsed / 1e6, base / elapsed);
+    if (threads == max_threads)
+      break;
+  }
+  return 0;
+}
@@ -11,6 +11,10 @@
 //  Reads input from file argument.
 //
 //  Option -l prints summary of flex actions.
+//  Option -d uses the hand-written scanner instead of flex's, and
+//  -j n scans all the files with it on n threads before printing any.
+//  Each file is then scanned from the initial state, rather than from
+//  wherever the previous file left the scanner.
 //
 //////////////////////////////////////////////////////////////////////////////
 
@@ -18,6 +22,8 @@
 #include <unistd.h>     // for getopt
 #include "cool-parse.h" // bison-generated file; defines tokens
 #include "utilities.h"
+#include "cool-dfa-lex.h"
+#include "phase-timer.h"
 
 //
 //  The lexer keeps this global variable up to date with the line number
@@ -51,6 +57,21 @@ void handle_flags(int argc, char *argv[]);
 //
 int  cool_yydebug;
 
+//
+//  cool_lex_map() makes the lexer scan a file directly from memory rather
+//  than reading it from fin; it fails harmlessly for input that can't be
+//  mapped.  cool_lex_unmap() releases the file once it has been scanned.
+//
+extern int cool_lex_map(FILE *f);
+extern void cool_lex_unmap();
+
+//
+//  With -d, the hand-written scanner in cool-dfa-lex.cc is used instead
+//  of the flex one; parallel_jobs is set by -j.
+//
+extern int dfa_lexer;
+extern int parallel_jobs;
+
 // defined in utilities.cc
 extern void dump_cool_token(ostream& out, int lineno, 
 			    int token, YYSTYPE yylval);
@@ -61,6 +82,28 @@ int main(int argc, char** argv) {
 	
 	handle_flags(argc,argv);
 
+	if (parallel_jobs > 0) {
+	    int nfiles = argc - optind;
+	    std::vector<CoolToken> *tokens = new std::vector<CoolToken>[nfiles];
+	    PhaseTimer lex_phase("lexing");
+	    int scanned = dfa_lex_files(nfiles, argv + optind, parallel_jobs, tokens);
+	    lex_phase.end();
+	    PhaseTimer write_phase("token write");
+	    for (int i = 0; i < scanned; i++) {
+		cout << "#name \"" << argv[optind + i] << "\"" << endl;
+		for (size_t j = 0; j < tokens[i].size(); j++)
+		    dump_cool_token(cout, tokens[i][j].lineno,
+				    tokens[i][j].token, tokens[i][j].value);
+	    }
+	    if (scanned < nfiles) {
+		cerr << "Could not open input file " << argv[optind + scanned] << endl;
+		exit(1);
+	    }
+	    exit(0);
+	}
+
+	// the tokens are written as they are scanned
+	PhaseTimer lex_phase("lexing");
 	while (optind < argc) {
 	    fin = fopen(argv[optind], "r");
 	    if (fin == NULL) {
@@ -72,14 +115,22 @@ int main(int argc, char** argv) {
             // this counter, so let's make the stand-alone lexer
             // do the same thing
             curr_lineno = 1;
+	    if (dfa_lexer)
+		cool_dfa_lex_begin(fin);
+	    else
+		cool_lex_map(fin);
 
 	    //
 	    // Scan and print all tokens.
 	    //
 	    cout << "#name \"" << argv[optind] << "\"" << endl;
-	    while ((token = cool_yylex()) != 0) {
+	    while ((token = dfa_lexer ? cool_dfa_yylex() : cool_yylex()) != 0) {
 		dump_cool_token(cout, curr_lineno, token, cool_yylval);
 	    }
+	    if (dfa_lexer)
+		cool_dfa_lex_end();
+	    else
+		cool_lex_unmap();
 	    fclose(fin);
 	    optind++;
 	}
@@ -0,0 +1,443 @@
+/*
+ * cool-dfa-lex.cc
+ *
+ * A hand-written scanner for Cool, an alternative to the one flex builds
+ * from cool.flex.  It returns exactly the same tokens, cool_yylval values
+ * and line numbers, but instead of running flex's tables it decides what
+ * to do from the first character of each token and scans the rest with
+ * straight-line code.  Keywords are recognized after an identifier has
+ * been scanned, with the same perfect hash cool.flex uses (see
+ * cool-keywords.h).
+ *
+ * The whole input is in memory: a regular file is mapped, anything else
+ * is read in.  Within one DfaScanner, as in cool.flex, the start
+ * condition and comment nesting depth carry over from one input to the
+ * next.  See cool-dfa-lex.h for the interface; lextest selects it with
+ * -d, and with -j scans its files in parallel through dfa_lex_files.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <thread>
+#include <cool-dfa-lex.h>
+#include <stringtab.h>
+#include <utilities.h>
+#include "cool-keywords.h"
+
+extern int curr_lineno;
+extern YYSTYPE cool_yylval;
+
+/* Character classes */
+enum { ID_CHAR = 1, DIGIT = 2, UPPER = 4, LOWER = 8, STRING_CHAR = 16 };
+
+struct char_class_table {
+  unsigned char k[256];
+  char error_msg[256][2];      /* the message for an invalid character */
+};
+
+static constexpr char_class_table make_char_classes()
+{
+  char_class_table t = {};
+  for (int c = 0; c < 256; c++) {
+    unsigned char k = 0;
+    if (c >= '0' && c <= '9')
+      k |= DIGIT | ID_CHAR;
+    if (c >= 'A' && c <= 'Z')
+      k |= UPPER | ID_CHAR;
+    if (c >= 'a' && c <= 'z')
+      k |= LOWER | ID_CHAR;
+    if (c == '_')
+      k |= ID_CHAR;
+    if (c != '"' && c != '\\' && c != '\n' && c != '\0')
+      k |= STRING_CHAR;
+    t.k[c] = k;
+    t.error_msg[c][0] = (char) c;
+  }
+  return t;
+}
+
+static constexpr char_class_table char_class = make_char_classes();
+
+static inline int char_is(const char *p, int k)
+{
+  return char_class.k[(unsigned char) *p] & k;
+}
+
+DfaScanner::DfaScanner()
+  : cur(NULL), input_end(NULL), mapped(NULL), mapped_size(0), owned(NULL),
+    start(INITIAL), lp_star_count(0), lineno(1)
+{ }
+
+int DfaScanner::begin(FILE *f)
+{
+  struct stat st;
+  int fd = fileno(f);
+
+  end();
+
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void *m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m != MAP_FAILED) {
+      mapped = (char *) m;
+      mapped_size = st.st_size;
+      cur = mapped;
+      input_end = mapped + mapped_size;
+      return 1;
+    }
+  }
+
+  size_t size = 0, capacity = 1 << 16;
+  owned = (char *) malloc(capacity);
+  size_t n;
+  while (owned != NULL && (n = fread(owned + size, 1, capacity - size, f)) > 0) {
+    size += n;
+    if (size == capacity)
+      owned = (char *) realloc(owned, capacity *= 2);
+  }
+  if (owned == NULL)
+    return 0;
+  cur = owned;
+  input_end = owned + size;
+  return 1;
+}
+
+void DfaScanner::end()
+{
+  if (mapped != NULL)
+    munmap(mapped, mapped_size);
+  free(owned);
+  mapped = owned = NULL;
+  cur = input_end = NULL;
+}
+
+int DfaScanner::error(const char *msg)
+{
+  value.error_msg = msg;
+  return ERROR;
+}
+
+/*
+ * The body of a string constant; p is just past the opening quote.
+ */
+int DfaScanner::string_constant(const char *&p)
+{
+  const char *end = input_end;
+  char *b = string_buf;
+  char *limit = string_buf + MAX_STR_CONST - 1;
+  int null_flag = 0, too_long = 0;
+
+  for (;;) {
+    if (p == end)
+      return error("EOF in string constant");
+
+    /* a run of ordinary characters */
+    const char *run = p;
+    while (p < end && char_is(p, STRING_CHAR))
+      p++;
+    if (p > run) {
+      if (p - run > limit - b)
+        too_long = 1;
+      else {
+        memcpy(b, run, p - run);
+        b += p - run;
+      }
+      continue;
+    }
+
+    char c = *p++;
+    switch (c) {
+    case '"':
+      if (null_flag)
+        return error("String contains invalid character");
+      if (too_long)
+        return error("String constant too long");
+      value.symbol = stringtable.add_chars(string_buf, b - string_buf);
+      return STR_CONST;
+    case '\n':
+      lineno++;
+      return error("Unterminated string constant");
+    case '\0':
+      null_flag = 1;
+      continue;
+    }
+
+    /* a backslash; alone at the end of the input it stands for itself */
+    if (p < end) {
+      c = *p++;
+      switch (c) {
+      case 'b':  c = '\b'; break;
+      case 't':  c = '\t'; break;
+      case 'n':  c = '\n'; break;
+      case 'f':  c = '\f'; break;
+      case '\n': lineno++; break;
+      case '\0': null_flag = 1; continue;
+      }
+    }
+    if (b == limit)
+      too_long = 1;
+    else
+      *b++ = c;
+  }
+}
+
+/*
+ * The rest of a "--" comment.  Returns 0 if the input ends first, in
+ * which case the scanner stays in ONE_LINE_COMMENT.
+ */
+int DfaScanner::line_comment(const char *&p)
+{
+  const char *end = input_end;
+
+  start = ONE_LINE_COMMENT;
+  while (p < end && *p != '\n')
+    p++;
+  if (p == end)
+    return 0;
+  p++;
+  lineno++;
+  start = INITIAL;
+  return 1;
+}
+
+/*
+ * A (possibly nested) comment; p is just past the opening "(*".
+ */
+int DfaScanner::comment(const char *&p)
+{
+  const char *end = input_end;
+
+  lp_star_count++;
+  for (;;) {
+    if (p == end)
+      return error("EOF in comment");
+    char c = *p++;
+    if (c == '\n')
+      lineno++;
+    else if (c == '(' && p < end && *p == '*') {
+      p++;
+      lp_star_count++;
+    } else if (c == '*' && p < end && *p == ')') {
+      p++;
+      if (--lp_star_count == 0)
+        return 0;
+    }
+  }
+}
+
+int DfaScanner::lex()
+{
+  const char *p = cur;
+  const char *end = input_end;
+  int token;
+
+  if (start == ONE_LINE_COMMENT && !line_comment(p)) {
+    cur = p;
+    return 0;
+  }
+
+  for (;;) {
+    if (p == end) {
+      cur = p;
+      return 0;
+    }
+
+    const char *tok = p;
+    char c = *p++;
+    switch (c) {
+    case '\n':
+      lineno++;
+      continue;
+    case ' ': case '\t': case '\r': case '\f': case '\v':
+      continue;
+
+    case '-':
+      if (p < end && *p == '-') {
+        p++;
+        if (line_comment(p))
+          continue;
+        cur = p;
+        return 0;
+      }
+      token = c;
+      break;
+
+    case '(':
+      if (p < end && *p == '*') {
+        p++;
+        token = comment(p);
+        if (token == 0)
+          continue;
+        break;
+      }
+      token = c;
+      break;
+
+    case '*':
+      if (p < end && *p == ')') {
+        p++;
+        token = error("Unmatched *)");
+        break;
+      }
+      token = c;
+      break;
+
+    case '=':
+      if (p < end && *p == '>') {
+        p++;
+        token = DARROW;
+        break;
+      }
+      token = c;
+      break;
+
+    case '<':
+      if (p < end && *p == '=') {
+        p++;
+        token = LE;
+        break;
+      }
+      if (p < end && *p == '-') {
+        p++;
+        token = ASSIGN;
+        break;
+      }
+      token = c;
+      break;
+
+    case '+': case '/': case '.': case '~': case ',': case ':': case ';':
+    case ')': case '{': case '}': case '@':
+      token = c;
+      break;
+
+    case '"':
+      token = string_constant(p);
+      break;
+
+    default:
+      if (char_is(tok, DIGIT)) {
+        while (p < end && char_is(p, DIGIT))
+          p++;
+        value.symbol = inttable.add_chars(tok, p - tok);
+        token = INT_CONST;
+      } else if (char_is(tok, UPPER | LOWER)) {
+        while (p < end && char_is(p, ID_CHAR))
+          p++;
+        token = keyword_token(tok, p - tok);
+        if (token == BOOL_CONST)
+          value.boolean = *tok == 't';
+        else if (token == 0) {
+          value.symbol = idtable.add_chars(tok, p - tok);
+          token = char_is(tok, UPPER) ? TYPEID : OBJECTID;
+        }
+      } else {
+        token = error(char_class.error_msg[(unsigned char) c]);
+      }
+      break;
+    }
+    cur = p;
+    return token;
+  }
+}
+
+/*
+ * The scanner lextest and lex_bench drive one token at a time, through
+ * curr_lineno and cool_yylval like the flex one.
+ */
+static DfaScanner scanner;
+
+int cool_dfa_lex_begin(FILE *f)
+{
+  scanner.lineno = curr_lineno;
+  return scanner.begin(f);
+}
+
+int cool_dfa_yylex()
+{
+  int token = scanner.lex();
+  curr_lineno = scanner.lineno;
+  cool_yylval = scanner.value;
+  return token;
+}
+
+void cool_dfa_lex_end()
+{
+  scanner.end();
+}
+
+/*
+ * Parallel scanning.  Each thread repeatedly claims the next file not yet
+ * taken and scans all of it.  A file that cannot be opened stops threads
+ * from claiming files after it; the ones before it are still finished.
+ *
+ * The threads intern symbols in whatever order they get to them, so the
+ * new entries are then renumbered in the order of their first use in
+ * files[0], files[1], ..., which is how scanning the files one after
+ * another would have numbered them.
+ */
+int dfa_lex_files(int nfiles, char **files, int threads,
+                  std::vector<CoolToken> *tokens)
+{
+  int id_first = idtable.count();
+  int int_first = inttable.count();
+  int str_first = stringtable.count();
+  std::atomic<int> next(0);
+  std::atomic<int> failed(nfiles);
+
+  auto work = [&]() {
+    for (;;) {
+      int i = next++;
+      if (i >= nfiles || i > failed)
+        return;
+      FILE *f = fopen(files[i], "r");
+      DfaScanner s;
+      if (f == NULL || !s.begin(f)) {
+        if (f != NULL)
+          fclose(f);
+        for (int k = failed; i < k && !failed.compare_exchange_weak(k, i); )
+          ;
+        continue;
+      }
+      CoolToken t;
+      while ((t.token = s.lex()) != 0) {
+        t.lineno = s.lineno;
+        t.value = s.value;
+        tokens[i].push_back(t);
+      }
+      s.end();
+      fclose(f);
+    }
+  };
+
+  if (threads > nfiles)
+    threads = nfiles;
+  std::vector<std::thread> pool;
+  for (int j = 1; j < threads; j++)
+    pool.push_back(std::thread(work));
+  work();
+  for (auto &t : pool)
+    t.join();
+
+  idtable.renumber_begin(id_first);
+  inttable.renumber_begin(int_first);
+  stringtable.renumber_begin(str_first);
+  for (int i = 0; i < nfiles; i++)
+    for (size_t j = 0; j < tokens[i].size(); j++)
+      switch (tokens[i][j].token) {
+      case TYPEID:
+      case OBJECTID:
+        idtable.renumber((IdEntryP) tokens[i][j].value.symbol);
+        break;
+      case INT_CONST:
+        inttable.renumber((IntEntryP) tokens[i][j].value.symbol);
+        break;
+      case STR_CONST:
+        stringtable.renumber((StringEntryP) tokens[i][j].value.symbol);
+        break;
+      }
+  idtable.renumber_end();
+  inttable.renumber_end();
+  stringtable.renumber_end();
+  return failed;
+}
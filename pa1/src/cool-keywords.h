@@ -0,0 +1,94 @@
+/*
+ * cool-keywords.h
+ *
+ * Keyword recognition for both scanners.  An identifier is matched by a
+ * single rule and then looked up here, so the scanner's automaton only
+ * has to know what an identifier looks like.
+ *
+ * The lookup is a perfect hash over the lower case keywords: the first
+ * and last characters (folded to lower case) and the length pick one of
+ * 32 slots, and at most one keyword lives in each.  The slot table is
+ * built by the compiler from keyword_list, and the build fails if two
+ * keywords ever land in the same slot, so the list can be edited freely
+ * as long as keyword_hash still separates it.
+ */
+#ifndef _COOL_KEYWORDS_H_
+#define _COOL_KEYWORDS_H_
+
+#include <cool-parse.h>
+
+struct keyword_entry {
+  const char *name;            /* in lower case */
+  int len;
+  int token;
+};
+
+/* true and false are BOOL_CONSTs, and must start with a lower case letter */
+static constexpr keyword_entry keyword_list[] = {
+  { "class", 5, CLASS },      { "else", 4, ELSE },     { "fi", 2, FI },
+  { "if", 2, IF },            { "in", 2, IN },         { "inherits", 8, INHERITS },
+  { "let", 3, LET },          { "loop", 4, LOOP },     { "pool", 4, POOL },
+  { "then", 4, THEN },        { "while", 5, WHILE },   { "case", 4, CASE },
+  { "esac", 4, ESAC },        { "of", 2, OF },         { "new", 3, NEW },
+  { "isvoid", 6, ISVOID },    { "not", 3, NOT },
+  { "true", 4, BOOL_CONST },  { "false", 5, BOOL_CONST },
+};
+
+#define KEYWORD_COUNT (int) (sizeof(keyword_list) / sizeof(keyword_list[0]))
+#define KEYWORD_MIN_LEN 2
+#define KEYWORD_MAX_LEN 8
+#define KEYWORD_SLOTS 32
+
+/*
+ * s is an identifier, so or-ing in 0x20 lower cases its letters and
+ * leaves digits alone; '_' becomes DEL, which no keyword contains.
+ */
+static constexpr int keyword_hash(const char *s, int len)
+{
+  return ((s[0] | 0x20) * 8 + (s[len - 1] | 0x20) * 5 + len) & (KEYWORD_SLOTS - 1);
+}
+
+struct keyword_slot_table {
+  signed char slot[KEYWORD_SLOTS];     /* index into keyword_list, or -1 */
+  bool perfect;
+};
+
+static constexpr keyword_slot_table make_keyword_slots()
+{
+  keyword_slot_table t = {};
+  t.perfect = true;
+  for (int h = 0; h < KEYWORD_SLOTS; h++)
+    t.slot[h] = -1;
+  for (int k = 0; k < KEYWORD_COUNT; k++) {
+    int h = keyword_hash(keyword_list[k].name, keyword_list[k].len);
+    if (t.slot[h] != -1)
+      t.perfect = false;
+    t.slot[h] = k;
+  }
+  return t;
+}
+
+static constexpr keyword_slot_table keyword_slots = make_keyword_slots();
+static_assert(keyword_slots.perfect, "keyword_hash has a collision");
+
+/*
+ * The token for the identifier at s, which is len characters long, or 0
+ * if it is not a keyword.  For BOOL_CONST the value is s[0] == 't'.
+ */
+static inline int keyword_token(const char *s, int len)
+{
+  if (len < KEYWORD_MIN_LEN || len > KEYWORD_MAX_LEN)
+    return 0;
+  int k = keyword_slots.slot[keyword_hash(s, len)];
+  if (k < 0 || keyword_list[k].len != len)
+    return 0;
+  const char *name = keyword_list[k].name;
+  for (int i = 0; i < len; i++)
+    if ((s[i] | 0x20) != name[i])
+      return 0;
+  if (keyword_list[k].token == BOOL_CONST && s[0] != name[0])
+    return 0;
+  return keyword_list[k].token;
+}
+
+#endif
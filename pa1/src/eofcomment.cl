@@ -0,0 +1 @@
+class A { (* (* nested *) EOF inside
\ No newline at end of file
@@ -0,0 +1 @@
+class A { s : String <- "EOF inside
\ No newline at end of file
@@ -0,0 +1,3 @@
+(* keywords in any case; true and false only with a lower case first letter *)
+CLASS Class cLaSs tRuE True false FALSE fAlse if_ i_f Inherits isvoid1 _x x_ ISVOID nOT
+esac Esac oF nEw LET lOOP pool THEN wHiLe fi ElSe In
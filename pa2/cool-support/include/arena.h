@@ -0,0 +1,87 @@
+// -*-Mode: C++;-*-
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+//////////////////////////////////////////////////////////////////////
+//
+//  arena.h
+//
+//  A bump allocator for objects that live as long as the compiler
+//  does (string table entries, their strings, AST nodes).  Memory is
+//  carved out of large blocks obtained from malloc; nothing allocated
+//  from an Arena is ever freed individually, and the blocks themselves
+//  are never returned.  Construct objects in an Arena with placement
+//  new:
+//
+//      IdEntry *e = new (arena.allocate(sizeof(IdEntry))) IdEntry(...);
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+class Arena {
+private:
+  enum { BLOCK_SIZE = 64 * 1024 };
+
+  char *next;      // first free byte of the current block
+  char *limit;     // one past the end of the current block
+  long blocks;     // number of blocks obtained from malloc
+  long bytes;      // number of bytes handed out
+
+  char *new_block(size_t size) {
+    char *b = (char *) malloc(size);
+    if (b == NULL) {
+      fputs("Arena: out of memory\n", stderr);
+      abort();
+    }
+    blocks++;
+    return b;
+  }
+
+public:
+  // Constant-initialized, so an Arena with static storage duration can be
+  // used by other translation units' static constructors.
+  constexpr Arena() : next(NULL), limit(NULL), blocks(0), bytes(0) { }
+
+  // Return size bytes aligned to align, which must be a power of two.
+  void *allocate(size_t size, size_t align = alignof(max_align_t)) {
+    char *p = (char *) (((size_t) next + align - 1) & ~(align - 1));
+    if (next == NULL || p + size > limit) {
+      if (size > BLOCK_SIZE / 4) {
+        // big requests get a block of their own so the current block
+        // keeps its free space
+        bytes += size;
+        return new_block(size);
+      }
+      next = new_block(BLOCK_SIZE);
+      limit = next + BLOCK_SIZE;
+      p = next;
+    }
+    next = p + size;
+    bytes += size;
+    return p;
+  }
+
+  // Copy the first len characters of s into the arena, adding a '\0'.
+  char *copy_string(const char *s, int len) {
+    char *str = (char *) allocate(len + 1, 1);
+    memcpy(str, s, len);
+    str[len] = '\0';
+    return str;
+  }
+
+  long block_count() const { return blocks; }
+  long bytes_allocated() const { return bytes; }
+};
+
+#endif
@@ -0,0 +1,82 @@
+// -*-Mode: C++;-*-
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef _PARSE_CONTEXT_H_
+#define _PARSE_CONTEXT_H_
+
+//////////////////////////////////////////////////////////////////////
+//
+//  parse-context.h
+//
+//  The parser in cool.y is reentrant: all of the state of one parse,
+//  including its line number, error count and result, is in a
+//  ParseContext, so several can run at once on different threads.
+//  They share only the string tables, which lock while adding.
+//
+//  A ParseContext either reads the token stream through cool_yylex as
+//  the parser always has, or parses the tokens of one file read in
+//  beforehand.  read_token_files reads the stream that way, and
+//  parse_files parses the files on several threads and joins their
+//  classes into one program.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+#include "cool-tree.h"
+#include "cool-dfa-lex.h"
+
+struct ParseContext {
+  const char *filename;         // the file being parsed
+  int lineno;                   // the line of the last token read
+  int token;                    // the last token read, for error messages
+  YYSTYPE value;                // and its value
+  int errors;                   // syntax errors found so far
+  Classes classes;              // the classes parsed so far
+  Program program;              // the result
+
+  // If tokens is NULL the token stream is read and errors are printed as
+  // they are found.  Otherwise the tokens from tokens[next] on are parsed
+  // and the error messages are kept in messages for the caller to print.
+  const std::vector<CoolToken> *tokens;
+  size_t next;
+  std::vector<std::string> messages;
+
+  ParseContext(const char *filename, int lineno,
+               const std::vector<CoolToken> *tokens = NULL)
+    : filename(filename), lineno(lineno), token(0), errors(0),
+      classes(NULL), program(NULL), tokens(tokens), next(0) { }
+};
+
+int cool_yyparse(ParseContext *ctx);
+
+// print_cool_token for a token other than the last one lexed (utilities.cc)
+void print_cool_token(ostream& out, int tok, YYSTYPE yylval);
+
+struct TokenFile {
+  const char *filename;
+  std::vector<CoolToken> tokens;
+};
+
+//
+// Read the whole token stream, starting a new file at each #name line.
+//
+void read_token_files(std::vector<TokenFile> &files);
+
+//
+// Parse files on up to threads threads and join their classes, in order,
+// into one program.  Errors are reported in file order and counted in
+// *errors; the program is NULL if there were any.  Since each file is
+// parsed on its own, error recovery stops at the end of a file: a class
+// left open at the end of one file is a syntax error at EOF in that
+// file, where one parse of the whole stream reports the error at the
+// first token of the next file instead.
+//
+Program parse_files(const std::vector<TokenFile> &files, int threads,
+                    int *errors);
+
+#endif
@@ -33,7 +33,13 @@
 //   The public methods are:
 //       tree_node()
 //         builds a new tree_node.  The type field is NULL, the
-//         line_number is set to the value of the global yylineno.
+//         line_number is set to the value of the global yylineno,
+//         or rather to *node_lineno (see below).
+//
+//       new, delete
+//         nodes come from the arena of the thread that makes them
+//         (see tree.cc) and live until the compiler exits; deleting
+//         a node only runs its destructor.
 //
 //       void dump(ostream& s,int n); 
 //         dump is a pretty printer for tree nodes.  The ostream argument
@@ -49,11 +55,19 @@
 //
 //
 ////////////////////////////////////////////////////////////////////////////
+//
+// Where new nodes get their line numbers: &curr_lineno, unless this
+// thread is running a parser with a line counter of its own.
+//
+extern thread_local int *node_lineno;
+
 class tree_node {
 protected:
     int line_number;            // stash the line number when node is made
 public:
     tree_node();
+    static void *operator new(size_t size);
+    static void operator delete(void *p) { }
     virtual tree_node *copy() = 0;
     virtual void dump(ostream& stream, int n) = 0;
     int get_line_number();
@@ -78,7 +92,8 @@ public:
 //
 //     Elem nth(int n);
 //     returns the nth element of a list.  If the list has fewer than n
-//     elements, an error is generated.
+//     elements, an error is generated.  This takes constant time: see
+//     "Representation" below.
 //
 //     int first();
 //     int next(int n);
@@ -95,8 +110,7 @@ public:
 //
 //     nth_length(int n, int &len);
 //     Returns the nth element of the list or NULL if there are not n elements.
-//     "len" is set to the length of the list.  This method is used internally
-//     by the APS package to efficiently traverse the list representation.  
+//     "len" is set to the length of the list.
 //
 //     static list_node<Elem> *nil();
 //     static list_node<Elem> *single(Elem);
@@ -110,9 +124,47 @@ public:
 //     list_node<Elem>::single(e);     where "e" has type Elem
 //     list_node<Elem>::append(l1,l2);
 //
+//  Representation
+//
+//     Every list keeps its elements in one array, so len, nth and the
+//     iterator take constant time however the list was built.  Lists are
+//     never changed once made, so a list made by appending shares the
+//     array of the list it extends: if l1's elements end where the used
+//     part of its array does, append(l1,l2) copies l2's elements in after
+//     them, and l1 just goes on seeing its own prefix.  Likewise a list
+//     whose elements start the used part of its array can have elements
+//     put in front of it.  Otherwise append copies both lists into a new
+//     array with room to grow, so building a list by repeatedly adding at
+//     either end takes time linear in its length.  Arrays come from the
+//     node arena and, like nodes, are never freed.
+//
 //////////////////////////////////////////////////////////////////////////////
 
+//
+// Where nodes and list arrays are allocated (see tree.cc).
+//
+void *node_alloc(size_t size);
+
 template <class Elem> class list_node : public tree_node {
+protected:
+    //
+    // An array of elements, shared by the lists made from one another.
+    // [lo, hi) is the part some list uses; [start, end) is all of it.
+    //
+    struct array {
+	Elem *start, *end;
+	Elem *lo, *hi;
+    };
+
+    Elem *elems;                // this list is elems[0 .. length-1]
+    int length;
+    array *shared;              // the array elems is in, or NULL if it
+				// cannot be added to
+
+    list_node() : elems(NULL), length(0), shared(NULL) { }
+    void concat(list_node<Elem> *l1, list_node<Elem> *l2);
+    void copy_elems(list_node<Elem> *l);
+
 public:
     tree_node *copy()            { return copy_list(); }
     Elem nth(int n);
@@ -121,11 +173,11 @@ public:
     //
     int first()      { return 0; }
     int next(int n)  { return n + 1; }
-    int more(int n)  { return (n < len()); }
+    int more(int n)  { return (n < length); }
 
     virtual list_node<Elem> *copy_list() = 0;
-    virtual int len() = 0;
-    virtual Elem nth_length(int n, int &len) = 0;
+    int len()        { return length; }
+    Elem nth_length(int n, int &len);
 
     static list_node<Elem> *nil();
     static list_node<Elem> *single(Elem);
@@ -139,8 +191,6 @@ extern int info_size;
 template <class Elem> class nil_node : public list_node<Elem> {
 public:
     list_node<Elem> *copy_list();
-    int len();
-    Elem nth_length(int n, int &len);
     void dump(ostream& stream, int n);
 };
 
@@ -149,25 +199,22 @@ template <class Elem> class single_list_node : public list_node<Elem> {
 public:
     single_list_node(Elem t) {
 	elem = t;
+	this->elems = &elem;
+	this->length = 1;
     }
     list_node<Elem> *copy_list();
-    int len();
-    Elem nth_length(int n, int &len);
     void dump(ostream& stream, int n);
 };
 
 
 template <class Elem> class append_node : public list_node<Elem> {
 private:
-    list_node<Elem> *some, *rest;
+    append_node() { }
 public:
     append_node(list_node<Elem> *l1, list_node<Elem> *l2) {
-	some = l1;
-	rest = l2;
+	this->concat(l1, l2);
     }
     list_node<Elem> *copy_list();
-    int len();
-    Elem nth_length(int n, int &len);
     void dump(ostream& stream, int n);
 };
 
@@ -194,111 +241,143 @@ template <class Elem> list_node<Elem> *list_node<Elem>::append(list_node<Elem> *
 
 template <class Elem> Elem list_node<Elem>::nth(int n)
 {
-    int len;
-    Elem tmp = nth_length(n ,len);
-
-    if (tmp)
-	return tmp;
+    if (n >= 0 && n < length && elems[n])
+	return elems[n];
     else {
 	cerr << "error: outside the range of the list\n";
 	exit(1);
     }
 }
 
-///////////////////////////////////////////////////////////////////////////
-//
-// nil_node::copy_list
-//
-// return the deep copy of the nil_node
-//
-///////////////////////////////////////////////////////////////////////////
-template <class Elem> list_node<Elem> *nil_node<Elem>::copy_list()
-{
-    return new nil_node<Elem>();
-}
-
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// nil_node::len
+// list_node::nth_length
 //
-// return the length of the nil_node
+// return the nth element on the list
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> int nil_node<Elem>::len()
+template <class Elem> Elem list_node<Elem>::nth_length(int n, int &len)
 {
-    return 0;
+    len = length;
+    if (n >= 0 && n < length)
+	return elems[n];
+    else
+	return NULL;
 }
 
 
-
 ///////////////////////////////////////////////////////////////////////////
 //
-// nil_node::nth_length
+// list_node::concat
 //
-// return the nth element on the list
+// make this list the elements of l1 followed by those of l2, adding to
+// l1's or l2's array if there is room next to them
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> Elem nil_node<Elem>::nth_length(int, int &len)
+template <class Elem> void list_node<Elem>::concat(list_node<Elem> *l1,
+						   list_node<Elem> *l2)
 {
-    len = 0;
-    return NULL;
+    int n1 = l1->length, n2 = l2->length;
+    array *a1 = l1->shared, *a2 = l2->shared;
+
+    length = n1 + n2;
+    if (n2 == 0) {
+	elems = l1->elems;
+	shared = a1;
+    } else if (n1 == 0) {
+	elems = l2->elems;
+	shared = a2;
+    } else if (a1 && l1->elems + n1 == a1->hi && a1->end - a1->hi >= n2) {
+	for (int i = 0; i < n2; i++)
+	    a1->hi[i] = l2->elems[i];
+	a1->hi += n2;
+	elems = l1->elems;
+	shared = a1;
+    } else if (a2 && l2->elems == a2->lo && a2->lo - a2->start >= n1) {
+	a2->lo -= n1;
+	for (int i = 0; i < n1; i++)
+	    a2->lo[i] = l1->elems[i];
+	elems = a2->lo;
+	shared = a2;
+    } else {
+	//
+	// A new array twice as long as the list, with the spare room at
+	// the end that is being added to (the right end by default).
+	//
+	int size = 2 * length;
+	shared = (array *) node_alloc(sizeof(array));
+	shared->start = (Elem *) node_alloc(size * sizeof(Elem));
+	shared->end = shared->start + size;
+	if (a2 && l2->elems == a2->lo && !(a1 && l1->elems + n1 == a1->hi))
+	    shared->lo = shared->end - length;
+	else
+	    shared->lo = shared->start;
+	shared->hi = shared->lo + length;
+	elems = shared->lo;
+	for (int i = 0; i < n1; i++)
+	    elems[i] = l1->elems[i];
+	for (int i = 0; i < n2; i++)
+	    elems[n1 + i] = l2->elems[i];
+    }
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// nil_node::dump
+// list_node::copy_elems
 //
-// dump for list node
+// make this list deep copies of the elements of l, in an array of its own
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> void nil_node<Elem>::dump(ostream& stream, int n)
+template <class Elem> void list_node<Elem>::copy_elems(list_node<Elem> *l)
 {
-    stream << pad(n) << "(nil)\n";
+    length = l->length;
+    shared = (array *) node_alloc(sizeof(array));
+    shared->start = shared->lo = elems =
+	(Elem *) node_alloc(length * sizeof(Elem));
+    shared->end = shared->hi = elems + length;
+    for (int i = 0; i < length; i++)
+	elems[i] = (Elem) l->elems[i]->copy();
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// single_list_node::copy_list
+// nil_node::copy_list
 //
-// return the deep copy of the single_list_node
+// return the deep copy of the nil_node
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> list_node<Elem> *single_list_node<Elem>::copy_list()
+template <class Elem> list_node<Elem> *nil_node<Elem>::copy_list()
 {
-    return new single_list_node<Elem>((Elem) elem->copy());
+    return new nil_node<Elem>();
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// single_list_node::len
+// nil_node::dump
 //
-// return the length of the single_list_node
+// dump for list node
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> int single_list_node<Elem>::len()
+template <class Elem> void nil_node<Elem>::dump(ostream& stream, int n)
 {
-    return 1;
+    stream << pad(n) << "(nil)\n";
 }
 
 
 ///////////////////////////////////////////////////////////////////////////
 //
-// single_list_node::nth_length
+// single_list_node::copy_list
 //
-// return the nth element on the list
+// return the deep copy of the single_list_node
 //
 ///////////////////////////////////////////////////////////////////////////
-template <class Elem> Elem single_list_node<Elem>::nth_length(int n, int &len)
+template <class Elem> list_node<Elem> *single_list_node<Elem>::copy_list()
 {
-    len = 1;
-    if (n)
-	return NULL;
-    else
-	return elem;
+    return new single_list_node<Elem>((Elem) elem->copy());
 }
 
 
@@ -324,40 +403,9 @@ template <class Elem> void single_list_node<Elem>::dump(ostream& stream, int n)
 ///////////////////////////////////////////////////////////////////////////
 template <class Elem> list_node<Elem> *append_node<Elem>::copy_list()
 {
-    return new append_node<Elem>(some->copy_list(), rest->copy_list());
-}
-
-
-///////////////////////////////////////////////////////////////////////////
-//
-// append_node::len
-//
-// return the length of the append_node
-//
-///////////////////////////////////////////////////////////////////////////
-template <class Elem> int append_node<Elem>::len()
-{
-    return some->len() + rest->len();
-}
-
-
-///////////////////////////////////////////////////////////////////////////
-//
-// append_node::nth_length
-//
-// return the nth element on the list
-//
-///////////////////////////////////////////////////////////////////////////
-template <class Elem> Elem append_node<Elem>::nth_length(int n, int &len)
-{
-    int rlen;
-    Elem tmp = some->nth_length(n, len);
-
-    if (!tmp) {
-	tmp = rest->nth_length(n-len, rlen);
-	len += rlen;
-    }
-    return tmp;
+    append_node<Elem> *l = new append_node<Elem>();
+    l->copy_elems(this);
+    return l;
 }
 
 
@@ -372,7 +420,7 @@ template <class Elem> void append_node<Elem>::dump(ostream& stream, int n)
 {
     int i, size;
 
-    size = len();
+    size = this->len();
     stream << pad(n) << "list\n";
     for (i = 0; i < size; i++)
 	this->nth(i)->dump(stream, n+2);
@@ -81,6 +81,9 @@ typedef union {
 # define YYSTYPE yystype
 # define YYSTYPE_IS_TRIVIAL 1
 #endif
+/* No locations are kept, so the stacks may be moved when they grow;
+   otherwise an AST nested more than YYINITDEPTH deep cannot be read. */
+#define YYLTYPE_IS_TRIVIAL 1
 #ifndef YYDEBUG
 # define YYDEBUG 1
 #endif
@@ -5,17 +5,21 @@
  */
 %{
 #include <iostream>
+#include <sstream>
+#include <atomic>
+#include <thread>
 #include "cool-tree.h"
 #include "stringtab.h"
 #include "utilities.h"
 
 /* Add your own C declarations here */
+struct ParseContext;          /* the state of one parse; see parse-context.h */
 
 
 /************************************************************************/
 /*                DONT CHANGE ANYTHING IN THIS SECTION                  */
 
-extern int yylex();           /* the entry point to the lexer  */
+extern int yylex();           /* the entry point to the token stream lexer */
 extern int curr_lineno;
 extern char *curr_filename;
 Program ast_root;            /* the result of the parse  */
@@ -28,7 +32,7 @@ int omerrs = 0;              /* number of errors in lexing and parsing */
    location in the file where the error was found. You should not change the
    error message of yyerror, since it will be used for grading puproses.
 */
-void yyerror(const char *s);
+void yyerror(ParseContext *ctx, const char *s);
 
 /*
    The VERBOSE_ERRORS flag can be used in order to provide more detailed error
@@ -65,6 +69,27 @@ extern int VERBOSE_ERRORS;
   char *error_msg;
 }
 
+/*
+   The parser is pure: each call of cool_yyparse works on the ParseContext
+   it is given, so several can parse different files at once.  The context
+   and the YYSTYPE it holds come from parse-context.h, through cool-parse.h,
+   so that the token numbers and values the parser sees are those of the
+   rest of the compiler (the %union above only gives Bison the member
+   names).  YYTOKENTYPE keeps Bison from declaring the tokens a second time.
+*/
+%code requires {
+#define YYTOKENTYPE
+#include "parse-context.h"
+}
+
+%code {
+int yylex(YYSTYPE *lvalp, ParseContext *ctx);
+}
+
+%define api.pure full
+%parse-param {ParseContext *ctx}
+%lex-param {ParseContext *ctx}
+
 /* 
    Declare the terminals; a few have types for associated lexemes.
    The token ERROR is never used in the parser; thus, it is a parse
@@ -126,8 +151,7 @@ extern int VERBOSE_ERRORS;
 program: 
         class_list 
                 {
-                        @$ = @1; 
-                        ast_root = program($1); 
+                        ctx->program = program($1); 
                 }
         ;
 
@@ -135,12 +159,12 @@ class_list:
         class            /* single class */
                 { 
                         $$ = single_Classes($1); 
-                        parse_results = $$;
+                        ctx->classes = $$;
                 }
         | class_list class /* several classes */
                 { 
                         $$ = append_Classes($1,single_Classes($2)); 
-                        parse_results = $$;
+                        ctx->classes = $$;
                 }
         ;
 
@@ -148,11 +172,11 @@ class_list:
 class:  
         class_head TYPEID INHERITS TYPEID '{' feature_list
                 { 
-                        $$ = class_($2,$4,$6,stringtable.add_string(curr_filename)); 
+                        $$ = class_($2,$4,$6,stringtable.add_string(ctx->filename)); 
                 }
         | class_head TYPEID '{' feature_list
                 { 
-                        $$ = class_($2,idtable.add_string("Object"),$4,stringtable.add_string(curr_filename)); 
+                        $$ = class_($2,idtable.add_string("Object"),$4,stringtable.add_string(ctx->filename)); 
                 }
         ;
 
@@ -174,7 +198,11 @@ class_error:
                 }
         ;
 
-/* Feature list may be empty, but no empty features in list. */
+/*
+   Feature list may be empty, but no empty features in list.  The error
+   alternatives of the list rules below still give a list, since building
+   a list looks at the lists it is made from.
+*/
 feature_list: 
         feature feature_list
                 {
@@ -228,7 +256,7 @@ formal_list:
                 }
         | error ')'
                 {
-                        
+                        $$ = nil_Formals();
                 }
         ;
 
@@ -254,11 +282,11 @@ expression_sem_list:
                 }
         | error ';' '}'
                 {
-
+                        $$ = nil_Expressions();
                 }
         | error '}'
                 {
-
+                        $$ = nil_Expressions();
                 }
         | error ';'
                 {
@@ -266,7 +294,7 @@ expression_sem_list:
                 }
           expression_sem_list
                 {
-
+                        $$ = $4;
                 }
         ;
 
@@ -281,7 +309,7 @@ expression_list:
                 }
         | error ')'
                 {
-
+                        $$ = nil_Expressions();
                 }
         | error ','
                 {
@@ -289,7 +317,7 @@ expression_list:
                 }
           expression_list
                 {
-
+                        $$ = $4;
                 }
         ;
 
@@ -463,19 +491,140 @@ assign_or_empty:
 /* end of grammar */
 %%
 
-/* This function is called automatically when Bison detects a parse error. */
-void yyerror(const char *s)
+/*
+   This function is called automatically when Bison detects a parse error.
+   Reading the token stream, it prints the message at once; otherwise it
+   keeps it in the context, and after too many errors the parse is ended
+   by cool_yylex below.
+*/
+void yyerror(ParseContext *ctx, const char *s)
 {
-  cerr << "\"" << curr_filename << "\", line " << curr_lineno << ": " \
+  if (ctx->errors > 20)
+    return;
+
+  std::ostringstream msg;
+  msg << "\"" << ctx->filename << "\", line " << ctx->lineno << ": " \
     << s << " at or near ";
-  print_cool_token(yychar);
-  cerr << endl;
-  omerrs++;
+  print_cool_token(msg, ctx->token, ctx->value);
+  msg << endl;
+  ctx->errors++;
 
-  if(omerrs>20) {
+  if (ctx->tokens != NULL) {
+    ctx->messages.push_back(msg.str());
+    return;
+  }
+  cerr << msg.str();
+  if(ctx->errors>20) {
       if (VERBOSE_ERRORS)
          fprintf(stderr, "More than 20 errors\n");
       exit(1);
   }
 }
 
+YYSTYPE cool_yylval;          /* set by the token stream lexer */
+
+/* The next token for the parse in ctx, from wherever it reads them. */
+int yylex(YYSTYPE *lvalp, ParseContext *ctx)
+{
+  if (ctx->tokens == NULL) {
+    ctx->token = yylex();
+    ctx->lineno = curr_lineno;
+    ctx->filename = curr_filename;
+    ctx->value = cool_yylval;
+  } else if (ctx->next < ctx->tokens->size() && ctx->errors <= 20) {
+    const CoolToken &t = (*ctx->tokens)[ctx->next++];
+    ctx->token = t.token;
+    ctx->lineno = t.lineno;
+    ctx->value = t.value;
+  } else
+    ctx->token = 0;
+  *lvalp = ctx->value;
+  return ctx->token;
+}
+
+void read_token_files(std::vector<TokenFile> &files)
+{
+  const char *filename = NULL;
+  int token;
+
+  while ((token = yylex()) != 0) {
+    if (curr_filename != filename) {
+      filename = curr_filename;
+      files.push_back(TokenFile());
+      files.back().filename = filename;
+    }
+    CoolToken t;
+    t.token = token;
+    t.lineno = curr_lineno;
+    t.value = cool_yylval;
+    files.back().tokens.push_back(t);
+  }
+}
+
+static const std::vector<CoolToken> no_tokens;
+
+/*
+   Each thread repeatedly claims the next file not yet taken and parses it,
+   giving the nodes it builds the line numbers of its own context.  The
+   file names are entered first, so that they are numbered as they would
+   be by one parse of the whole stream.
+*/
+Program parse_files(const std::vector<TokenFile> &files, int threads,
+                    int *errors)
+{
+  std::vector<ParseContext> ctx;
+  for (size_t i = 0; i < files.size(); i++) {
+    ctx.push_back(ParseContext(files[i].filename, curr_lineno, &files[i].tokens));
+    stringtable.add_string(files[i].filename);
+  }
+  /* With no tokens at all, the parse reports the missing class. */
+  if (ctx.empty())
+    ctx.push_back(ParseContext(curr_filename, curr_lineno, &no_tokens));
+  std::atomic<size_t> next(0);
+
+  auto work = [&]() {
+    for (;;) {
+      size_t i = next++;
+      if (i >= ctx.size())
+        return;
+      node_lineno = &ctx[i].lineno;
+      cool_yyparse(&ctx[i]);
+      node_lineno = &curr_lineno;
+    }
+  };
+
+  if (threads > (int) ctx.size())
+    threads = ctx.size();
+  std::vector<std::thread> pool;
+  for (int j = 1; j < threads; j++)
+    pool.push_back(std::thread(work));
+  work();
+  for (auto &t : pool)
+    t.join();
+
+  *errors = 0;
+  Classes classes = NULL;
+  for (size_t i = 0; i < ctx.size(); i++) {
+    for (size_t j = 0; j < ctx[i].messages.size(); j++) {
+      cerr << ctx[i].messages[j];
+      if (++*errors > 20) {
+        if (VERBOSE_ERRORS)
+          fprintf(stderr, "More than 20 errors\n");
+        exit(1);
+      }
+    }
+    /* A file with errors may have no classes; nothing is joined after it. */
+    if (*errors == 0)
+      classes = classes == NULL ? ctx[i].classes
+                                : append_Classes(classes, ctx[i].classes);
+  }
+  if (*errors != 0)
+    return NULL;
+
+  /* The program ends where the last file does. */
+  node_lineno = &ctx.back().lineno;
+  Program result = program(classes);
+  node_lineno = &curr_lineno;
+  parse_results = classes;
+  return result;
+}
@@ -0,0 +1,118 @@
+// -*-Mode: C++;-*-
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef _AST_BINARY_H_
+#define _AST_BINARY_H_
+
+//////////////////////////////////////////////////////////////////////
+//
+//  ast-binary.h
+//
+//  A compact binary form of the typed AST, used between semant and cgen
+//  in place of the text printed by dump_with_types and read back by the
+//  AST lexer and parser.  semant writes it when given -b; cgen accepts
+//  either form.
+//
+//  Layout (integers marked * are unsigned LEB128, sections are preceded
+//  by their length in bytes as a 4 byte little-endian integer):
+//
+//      "COOLAST" 1                     magic and format version
+//      symbol section:
+//          count*
+//          count times:  kind  length*  characters  '\0'
+//      node section:
+//          the program, in prefix order
+//
+//  A node is its tag, its line number* and then its components in the
+//  order dump_with_types prints them: symbols as an index* into the
+//  symbol section plus one (0 is a null symbol), booleans as one byte,
+//  lists as a length* followed by the elements, and for expressions the
+//  type last.  Symbols are numbered in order of first use, so reading
+//  the symbol section enters them into idtable, inttable and stringtable
+//  in the same order the text form would have.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cool-io.h"
+#include "stringtab.h"
+#include "tree.h"
+#include "cool-tree.h"
+
+#define AST_BINARY_MAGIC "COOLAST\1"
+#define AST_BINARY_MAGIC_LEN 8
+
+enum AstSymbolKind { AST_ID_SYMBOL, AST_INT_SYMBOL, AST_STRING_SYMBOL };
+
+enum AstTag {
+  AST_PROGRAM = 1, AST_CLASS, AST_METHOD, AST_ATTR, AST_FORMAL, AST_BRANCH,
+  AST_ASSIGN, AST_STATIC_DISPATCH, AST_DISPATCH, AST_COND, AST_LOOP,
+  AST_TYPCASE, AST_BLOCK, AST_LET, AST_PLUS, AST_SUB, AST_MUL, AST_DIVIDE,
+  AST_NEG, AST_LT, AST_EQ, AST_LEQ, AST_COMP, AST_INT, AST_BOOL, AST_STRING,
+  AST_NEW, AST_ISVOID, AST_NO_EXPR, AST_OBJECT
+};
+
+//
+// AstWriter collects the encoding of a tree; the dump_binary member of
+// each AST node feeds it its own components.  Nothing is written until
+// finish().
+//
+class AstWriter {
+private:
+  std::string symbols;         // the symbol section, without its count
+  int symbol_count;
+  std::string nodes;           // the node section
+  std::unordered_map<Symbol, int> index[AST_STRING_SYMBOL + 1];
+  std::vector<Symbol> used[AST_STRING_SYMBOL + 1];
+
+  void number(std::string &buf, unsigned n);
+  int symbol_index(AstSymbolKind kind, Symbol s);
+
+public:
+  AstWriter() : symbol_count(0) { }
+
+  void node(AstTag tag, tree_node *t);
+  void symbol(AstSymbolKind kind, Symbol s) { number(nodes, symbol_index(kind, s)); }
+  void boolean(Boolean b);
+  void length(int n) { number(nodes, n); }
+
+  template <class Elem> void list(list_node<Elem> *l) {
+    length(l->len());
+    for (int i = l->first(); l->more(i); i = l->next(i))
+      l->nth(i)->dump_binary(*this);
+  }
+
+  // Write the magic number and both sections to stream.
+  void finish(ostream& stream);
+
+  // The symbols of one kind written so far, in order of first use.
+  const std::vector<Symbol> &used_symbols(AstSymbolKind kind) const
+    { return used[kind]; }
+};
+
+//
+// Does the AST on f start with the binary magic number?  Only one
+// character is examined, and it is pushed back.
+//
+bool ast_binary_input(FILE *f);
+
+//
+// Read a binary AST from f, mapping it into memory when f is a regular
+// file.  Exits with a message if the input is not well formed.
+//
+Program ast_binary_read(FILE *f);
+
+//
+// Read a single class, written by its dump_binary and finish() in place
+// of a program, from data.  The class cache keeps classes this way.
+//
+Class_ ast_binary_read_class(const std::string &data);
+
+#endif
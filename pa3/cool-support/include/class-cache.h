@@ -0,0 +1,74 @@
+// -*-Mode: C++;-*-
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef _CLASS_CACHE_H_
+#define _CLASS_CACHE_H_
+
+//////////////////////////////////////////////////////////////////////
+//
+//  class-cache.h
+//
+//  A directory of results computed for one class at a time, kept from
+//  one run of the compiler to the next (-C dir).  semant stores each
+//  class's typed AST and error messages there, and cgen the code it
+//  emitted for the class, so that a class that has not changed is not
+//  checked or generated again.
+//
+//  An entry is found by a CacheKey: a hash of everything the result
+//  depends on, that is the class itself and whatever the caller adds
+//  about the classes it uses.  Two independent 64-bit hashes are kept;
+//  the first names the entry's file and the second is stored in it and
+//  compared on lookup.  Entries are written to a temporary file that is
+//  then renamed, so a reader never sees half of one.  An entry that
+//  cannot be read or written is only a miss.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class CacheKey {
+private:
+  uint64_t h1, h2;
+  void bytes(const char *s, size_t len);
+
+public:
+  // kind names the phase and version of the results, so that entries
+  // of different phases or compilers never match.
+  CacheKey(const char *kind);
+
+  // Add a field.  Fields are hashed with their lengths, so "ab","c"
+  // and "a","bc" differ.
+  void add(const char *s, size_t len);
+  void add(const char *s);
+  void add(const std::string &s) { add(s.data(), s.size()); }
+
+  uint64_t name() const { return h1; }
+  uint64_t check() const { return h2; }
+};
+
+class ClassCache {
+private:
+  std::string dir;
+  int hits, misses;
+
+  std::string path(const CacheKey &key);
+
+public:
+  // The directory is created if it does not exist.
+  ClassCache(const char *dir);
+
+  // Fill in value and return true if there is an entry for key.
+  bool lookup(const CacheKey &key, std::string &value);
+  void store(const CacheKey &key, const std::string &value);
+
+  int hit_count() const { return hits; }
+  int miss_count() const { return misses; }
+};
+
+#endif
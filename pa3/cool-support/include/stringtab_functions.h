@@ -5,17 +5,29 @@
 #include "copyright.h"
 
 #include "cool-io.h"
-#define MAXSIZE 1000000
-#define min(a,b) (a > b ? b : a)
-
 #include "stringtab.h"
 #include <stdio.h>
 
+#define MAXSIZE 1000000
+#define min(a,b) (a > b ? b : a)
+
 //
 // A string table is implemented a linked list of Entrys.  Each Entry
-// in the list has a unique string.
+// in the list has a unique string.  The list is indexed two ways so that
+// neither adding nor looking up a string has to walk it:
+//
+//   stripes  open-addressing hash tables (linear probing) keyed by the
+//            hash each Entry caches when it is created; the top bits of
+//            the hash choose the stripe.  Each stripe is kept at most
+//            half full and doubled when it gets fuller.
+//   entries  the Entrys in index order, so lookup(i) is a single load.
+//
+// The list itself is still maintained (newest Entry first) for code that
+// walks tbl directly.
 //
 
+#define INITIAL_CAPACITY 64
+
 template <class Elem>
 Elem *StringTable<Elem>::add_string(const char *s)
 {
@@ -23,26 +35,164 @@ Elem *StringTable<Elem>::add_string(const char *s)
 }
 
 //
-// Add a string requires two steps.  First, the list is searched; if the
-// string is found, a pointer to the existing Entry for that string is 
-// returned.  If the string is not found, a new Entry is created and added
-// to the list.
+// Return the Entry for the first len characters of s, or NULL if the
+// string is not in the table.  h must be Entry::hash_string(s,len), and
+// st must be stripe(h).
+//
+template <class Elem>
+Elem *StringTable<Elem>::find(Stripe &st, const char *s, int len, unsigned h)
+{
+  if (st.capacity == 0)
+    return NULL;
+  for (unsigned i = h & (st.capacity - 1); st.slots[i]; i = (i + 1) & (st.capacity - 1))
+    if (st.slots[i]->get_hash() == h && st.slots[i]->equal_string(s,len))
+      return st.slots[i];
+  return NULL;
+}
+
+//
+// Place a new Entry in its stripe of the hash index.  The caller holds
+// the stripe's lock and has checked that the string is not present.
+//
+template <class Elem>
+void StringTable<Elem>::insert(Stripe &st, Elem *e)
+{
+  if (2 * (st.count + 1) > st.capacity)
+    grow(st);
+
+  unsigned i = e->get_hash() & (st.capacity - 1);
+  while (st.slots[i])
+    i = (i + 1) & (st.capacity - 1);
+  st.slots[i] = e;
+  st.count++;
+}
+
+//
+// Double a stripe of the hash index, re-placing every Entry by its
+// cached hash.
+//
+template <class Elem>
+void StringTable<Elem>::grow(Stripe &st)
+{
+  int old_capacity = st.capacity;
+  Elem **old_slots = st.slots;
+
+  st.capacity = st.capacity ? 2 * st.capacity : INITIAL_CAPACITY;
+  st.slots = new Elem *[st.capacity];
+  memset(st.slots, 0, st.capacity * sizeof(Elem *));
+
+  for (int j = 0; j < old_capacity; j++) {
+    if (old_slots[j] == NULL)
+      continue;
+    unsigned i = old_slots[j]->get_hash() & (st.capacity - 1);
+    while (st.slots[i])
+      i = (i + 1) & (st.capacity - 1);
+    st.slots[i] = old_slots[j];
+  }
+  delete [] old_slots;
+}
+
+//
+// Give a new Entry the next index and add it to entries and the list.
+// The caller holds stringtab_lock.
+//
+template <class Elem>
+void StringTable<Elem>::append(Elem *e)
+{
+  if (index == entries_size) {
+    int size = entries_size ? 2 * entries_size : INITIAL_CAPACITY;
+    Elem **bigger = new Elem *[size];
+    memcpy(bigger, entries, entries_size * sizeof(Elem *));
+    delete [] entries;
+    entries = bigger;
+    entries_size = size;
+  }
+  entries[index] = e;
+  index++;
+  tbl = new (stringtab_arena.allocate(sizeof(List<Elem>))) List<Elem>(e, tbl);
+}
+
+//
+// Add a string requires two steps.  First, the string's stripe of the
+// hash index is probed; if the string is found, a pointer to the existing
+// Entry for that string is returned.  If the string is not found, a new
+// Entry is created and added to the list and to the index.  The stripe
+// stays locked throughout, so two threads adding the same new string
+// cannot both create it.
 //
 template <class Elem>
 Elem *StringTable<Elem>::add_string(const char *s, int maxchars)
 {
-  int len = min((int) strlen(s),maxchars);
-  for(List<Elem> *l = tbl; l; l = l->tl())
-    if (l->hd()->equal_string(s,len))
-      return l->hd();
+  return add_chars(s, min((int) strlen(s),maxchars));
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::add_chars(const char *s, int len)
+{
+  stringtab_interns.fetch_add(1, std::memory_order_relaxed);
+  unsigned h = Entry::hash_string(s,len);
+  Stripe &st = stripe(h);
+  std::lock_guard<std::mutex> guard(st.lock);
+  Elem *e = find(st, s, len, h);
+  if (e)
+    return e;
 
-  Elem *e = new Elem(s,len,index++);
-  tbl = new List<Elem>(e, tbl);
+  {
+    std::lock_guard<std::mutex> table_guard(stringtab_lock);
+    e = new (stringtab_arena.allocate(sizeof(Elem))) Elem(s,len,index);
+    append(e);
+  }
+  insert(st, e);
   return e;
 }
 
 //
-// To look up a string, the list is scanned until a matching Entry is located.
+// Renumbering.  renumbered[i] is the new index of the entry now numbered
+// i, or -1 until renumber gives it one.
+//
+template <class Elem>
+void StringTable<Elem>::renumber_begin(int first)
+{
+  assert(0 <= first && first <= index && renumbered == NULL);
+  renumbered = new int[index];
+  for (int i = 0; i < index; i++)
+    renumbered[i] = i < first ? i : -1;
+  renumber_first = renumber_next = first;
+}
+
+template <class Elem>
+void StringTable<Elem>::renumber(Elem *e)
+{
+  int i = e->get_index();
+  if (renumbered[i] < 0)
+    renumbered[i] = renumber_next++;
+}
+
+template <class Elem>
+void StringTable<Elem>::renumber_end()
+{
+  Elem **old = new Elem *[index];
+  memcpy(old, entries, index * sizeof(Elem *));
+  for (int i = renumber_first; i < index; i++)
+    if (renumbered[i] < 0)
+      renumbered[i] = renumber_next++;
+  for (int i = renumber_first; i < index; i++) {
+    entries[renumbered[i]] = old[i];
+    old[i]->set_index(renumbered[i]);
+  }
+
+  // rebuild the list, newest (highest index) first
+  tbl = NULL;
+  for (int i = 0; i < index; i++)
+    tbl = new (stringtab_arena.allocate(sizeof(List<Elem>))) List<Elem>(entries[i], tbl);
+
+  delete [] old;
+  delete [] renumbered;
+  renumbered = NULL;
+}
+
+//
+// To look up a string, the hash index is probed for a matching Entry.
 // If no such entry is found, an assertion failure occurs.  Thus, this function
 // is used only for strings that one expects to find in the table.
 //
@@ -50,11 +200,10 @@ template <class Elem>
 Elem *StringTable<Elem>::lookup_string(const char *s)
 {
   int len = strlen(s);
-  for(List<Elem> *l = tbl; l; l = l->tl())
-    if (l->hd()->equal_string(s,len))
-      return l->hd();
-  assert(0);   // fail if string is not found
-  return NULL; // to avoid compiler warning
+  unsigned h = Entry::hash_string(s,len);
+  Elem *e = find(stripe(h), s, len, h);
+  assert(e);   // fail if string is not found
+  return e;
 }
 
 //
@@ -64,11 +213,8 @@ Elem *StringTable<Elem>::lookup_string(const char *s)
 template <class Elem>
 Elem *StringTable<Elem>::lookup(int ind)
 {
-  for(List<Elem> *l = tbl; l; l = l->tl())
-    if (l->hd()->equal_index(ind))
-      return l->hd();
-  assert(0);   // fail if string is not found
-  return NULL; // to avoid compiler warning
+  assert(0 <= ind && ind < index);   // fail if string is not found
+  return entries[ind];
 }
 
 //
@@ -77,7 +223,7 @@ Elem *StringTable<Elem>::lookup(int ind)
 template <class Elem>
 Elem *StringTable<Elem>::add_int(int i)
 {
-  static char *buf = new char[20];
+  char buf[20];
   snprintf(buf, 20, "%d", i);
   return add_string(buf);
 }
@@ -0,0 +1,680 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vector>
+#include "cool.h"
+#include "tree.h"
+#include "cool-tree.h"
+#include "ast-binary.h"
+#include "utilities.h"
+
+extern int curr_lineno;
+
+//////////////////////////////////////////////////////////////////
+//
+//  ast-binary.cc
+//
+//  Writing and reading the binary AST described in ast-binary.h.
+//  Each AST node writes itself with dump_binary, visiting its
+//  components in the same order as dump_with_types; the reader below
+//  rebuilds the tree with the constructor functions of cool-tree.h,
+//  just as the AST parser does for the text form.
+//
+//////////////////////////////////////////////////////////////////
+
+void AstWriter::number(std::string &buf, unsigned n)
+{
+  while (n >= 0x80) {
+    buf += (char) (n | 0x80);
+    n >>= 7;
+  }
+  buf += (char) n;
+}
+
+int AstWriter::symbol_index(AstSymbolKind kind, Symbol s)
+{
+  if (s == NULL)
+    return 0;
+  std::unordered_map<Symbol, int>::iterator it = index[kind].find(s);
+  if (it != index[kind].end())
+    return it->second;
+  symbols += (char) kind;
+  number(symbols, s->get_len());
+  symbols.append(s->get_string(), s->get_len());
+  symbols += '\0';
+  used[kind].push_back(s);
+  return index[kind][s] = ++symbol_count;
+}
+
+void AstWriter::node(AstTag tag, tree_node *t)
+{
+  nodes += (char) tag;
+  number(nodes, t->get_line_number());
+}
+
+//
+// The text form spells a boolean as an integer constant, which the AST
+// lexer enters in inttable; note it here so that inttable ends up the
+// same either way.
+//
+void AstWriter::boolean(Boolean b)
+{
+  symbol_index(AST_INT_SYMBOL, inttable.add_string(b ? "1" : "0"));
+  nodes += (char) (b ? 1 : 0);
+}
+
+static void write_section_length(ostream& stream, size_t len)
+{
+  char buf[4];
+  for (int i = 0; i < 4; i++)
+    buf[i] = (char) (len >> (8 * i));
+  stream.write(buf, 4);
+}
+
+void AstWriter::finish(ostream& stream)
+{
+  std::string count;
+  number(count, symbol_count);
+  stream.write(AST_BINARY_MAGIC, AST_BINARY_MAGIC_LEN);
+  write_section_length(stream, count.size() + symbols.size());
+  stream << count << symbols;
+  write_section_length(stream, nodes.size());
+  stream << nodes;
+}
+
+//
+// dump_binary for each kind of node.
+//
+void program_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_PROGRAM, this);
+   w.list(classes);
+}
+
+void class__class::dump_binary(AstWriter& w)
+{
+   w.node(AST_CLASS, this);
+   w.symbol(AST_ID_SYMBOL, name);
+   w.symbol(AST_ID_SYMBOL, parent);
+   w.symbol(AST_STRING_SYMBOL, filename);
+   w.list(features);
+}
+
+void method_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_METHOD, this);
+   w.symbol(AST_ID_SYMBOL, name);
+   w.list(formals);
+   w.symbol(AST_ID_SYMBOL, return_type);
+   expr->dump_binary(w);
+}
+
+void attr_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_ATTR, this);
+   w.symbol(AST_ID_SYMBOL, name);
+   w.symbol(AST_ID_SYMBOL, type_decl);
+   init->dump_binary(w);
+}
+
+void formal_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_FORMAL, this);
+   w.symbol(AST_ID_SYMBOL, name);
+   w.symbol(AST_ID_SYMBOL, type_decl);
+}
+
+void branch_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_BRANCH, this);
+   w.symbol(AST_ID_SYMBOL, name);
+   w.symbol(AST_ID_SYMBOL, type_decl);
+   expr->dump_binary(w);
+}
+
+void assign_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_ASSIGN, this);
+   w.symbol(AST_ID_SYMBOL, name);
+   expr->dump_binary(w);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void static_dispatch_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_STATIC_DISPATCH, this);
+   expr->dump_binary(w);
+   w.symbol(AST_ID_SYMBOL, type_name);
+   w.symbol(AST_ID_SYMBOL, name);
+   w.list(actual);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void dispatch_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_DISPATCH, this);
+   expr->dump_binary(w);
+   w.symbol(AST_ID_SYMBOL, name);
+   w.list(actual);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void cond_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_COND, this);
+   pred->dump_binary(w);
+   then_exp->dump_binary(w);
+   else_exp->dump_binary(w);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void loop_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_LOOP, this);
+   pred->dump_binary(w);
+   body->dump_binary(w);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void typcase_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_TYPCASE, this);
+   expr->dump_binary(w);
+   w.list(cases);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void block_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_BLOCK, this);
+   w.list(body);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void let_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_LET, this);
+   w.symbol(AST_ID_SYMBOL, identifier);
+   w.symbol(AST_ID_SYMBOL, type_decl);
+   init->dump_binary(w);
+   body->dump_binary(w);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+#define BINARY_OP_DUMP(cls, tag)           \
+void cls::dump_binary(AstWriter& w)        \
+{                                          \
+   w.node(tag, this);                      \
+   e1->dump_binary(w);                     \
+   e2->dump_binary(w);                     \
+   w.symbol(AST_ID_SYMBOL, type);          \
+}
+
+#define UNARY_OP_DUMP(cls, tag)            \
+void cls::dump_binary(AstWriter& w)        \
+{                                          \
+   w.node(tag, this);                      \
+   e1->dump_binary(w);                     \
+   w.symbol(AST_ID_SYMBOL, type);          \
+}
+
+BINARY_OP_DUMP(plus_class, AST_PLUS)
+BINARY_OP_DUMP(sub_class, AST_SUB)
+BINARY_OP_DUMP(mul_class, AST_MUL)
+BINARY_OP_DUMP(divide_class, AST_DIVIDE)
+UNARY_OP_DUMP(neg_class, AST_NEG)
+BINARY_OP_DUMP(lt_class, AST_LT)
+BINARY_OP_DUMP(eq_class, AST_EQ)
+BINARY_OP_DUMP(leq_class, AST_LEQ)
+UNARY_OP_DUMP(comp_class, AST_COMP)
+UNARY_OP_DUMP(isvoid_class, AST_ISVOID)
+
+void int_const_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_INT, this);
+   w.symbol(AST_INT_SYMBOL, token);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void bool_const_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_BOOL, this);
+   w.boolean(val);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void string_const_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_STRING, this);
+   w.symbol(AST_STRING_SYMBOL, token);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void new__class::dump_binary(AstWriter& w)
+{
+   w.node(AST_NEW, this);
+   w.symbol(AST_ID_SYMBOL, type_name);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void no_expr_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_NO_EXPR, this);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+void object_class::dump_binary(AstWriter& w)
+{
+   w.node(AST_OBJECT, this);
+   w.symbol(AST_ID_SYMBOL, name);
+   w.symbol(AST_ID_SYMBOL, type);
+}
+
+//////////////////////////////////////////////////////////////////
+//
+//  Reading
+//
+//////////////////////////////////////////////////////////////////
+
+class AstReader {
+private:
+  const unsigned char *p;
+  const unsigned char *end;
+  std::vector<Symbol> symbols;   // symbols[0] is the null symbol
+
+  void malformed() {
+    cerr << "Malformed binary AST" << endl;
+    exit(1);
+  }
+
+  unsigned char byte() {
+    if (p >= end)
+      malformed();
+    return *p++;
+  }
+
+  unsigned number() {
+    unsigned n = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+      unsigned char b = byte();
+      n |= (unsigned) (b & 0x7f) << shift;
+      if (!(b & 0x80))
+        return n;
+    }
+    malformed();
+    return 0;
+  }
+
+  size_t section_length() {
+    size_t len = 0;
+    for (int i = 0; i < 4; i++)
+      len |= (size_t) byte() << (8 * i);
+    if (len > (size_t) (end - p))
+      malformed();
+    return len;
+  }
+
+  Symbol symbol() {
+    unsigned i = number();
+    if (i >= symbols.size())
+      malformed();
+    return symbols[i];
+  }
+
+  // Reading a node's components moves curr_lineno, so each node sets
+  // it to its own line just before it is constructed.
+  int line() { return (int) number(); }
+
+  void read_header();
+  void read_symbols();
+  Class_ read_class();
+  Feature read_feature();
+  Formal read_formal();
+  Case read_case();
+  Expression read_expression();
+
+  template <class Elem>
+  list_node<Elem> *read_list(list_node<Elem> *(*nil)(),
+                             list_node<Elem> *(*single)(Elem),
+                             list_node<Elem> *(*append)(list_node<Elem> *, list_node<Elem> *),
+                             Elem (AstReader::*read_elem)()) {
+    unsigned n = number();
+    if (n == 0)
+      return nil();
+    list_node<Elem> *l = single((this->*read_elem)());
+    for (unsigned i = 1; i < n; i++)
+      l = append(l, single((this->*read_elem)()));
+    return l;
+  }
+
+public:
+  AstReader(const char *data, size_t size)
+    : p((const unsigned char *) data), end((const unsigned char *) data + size) { }
+  Program read_program();
+  Class_ read_single_class();
+};
+
+void AstReader::read_symbols()
+{
+  size_t len = section_length();
+  const unsigned char *section_end = p + len;
+  unsigned count = number();
+  symbols.reserve(count + 1);
+  symbols.push_back(NULL);
+  for (unsigned i = 0; i < count; i++) {
+    unsigned char kind = byte();
+    unsigned len = number();
+    if (len >= (size_t) (section_end - p) || p[len] != '\0')
+      malformed();
+    const char *s = (const char *) p;
+    p += len + 1;
+    switch (kind) {
+    case AST_ID_SYMBOL:     symbols.push_back(idtable.add_string(s, len)); break;
+    case AST_INT_SYMBOL:    symbols.push_back(inttable.add_string(s, len)); break;
+    case AST_STRING_SYMBOL: symbols.push_back(stringtable.add_string(s, len)); break;
+    default:                malformed();
+    }
+  }
+  if (p != section_end)
+    malformed();
+}
+
+void AstReader::read_header()
+{
+  if ((size_t) (end - p) < AST_BINARY_MAGIC_LEN ||
+      memcmp(p, AST_BINARY_MAGIC, AST_BINARY_MAGIC_LEN) != 0)
+    malformed();
+  p += AST_BINARY_MAGIC_LEN;
+  read_symbols();
+}
+
+Program AstReader::read_program()
+{
+  read_header();
+  size_t len = section_length();
+  const unsigned char *section_end = p + len;
+
+  if (byte() != AST_PROGRAM)
+    malformed();
+  int lineno = line();
+  Classes classes = read_list(nil_Classes, single_Classes, append_Classes,
+                              &AstReader::read_class);
+  curr_lineno = lineno;
+  Program result = program(classes);
+  if (p != section_end)
+    malformed();
+  return result;
+}
+
+Class_ AstReader::read_single_class()
+{
+  read_header();
+  size_t len = section_length();
+  const unsigned char *section_end = p + len;
+  Class_ result = read_class();
+  if (p != section_end)
+    malformed();
+  return result;
+}
+
+Class_ AstReader::read_class()
+{
+  if (byte() != AST_CLASS)
+    malformed();
+  int lineno = line();
+  Symbol name = symbol();
+  Symbol parent = symbol();
+  Symbol filename = symbol();
+  Features features = read_list(nil_Features, single_Features, append_Features,
+                                &AstReader::read_feature);
+  curr_lineno = lineno;
+  return class_(name, parent, features, filename);
+}
+
+Feature AstReader::read_feature()
+{
+  unsigned char tag = byte();
+  int lineno = line();
+  Symbol name = symbol();
+  if (tag == AST_METHOD) {
+    Formals formals = read_list(nil_Formals, single_Formals, append_Formals,
+                                &AstReader::read_formal);
+    Symbol return_type = symbol();
+    Expression expr = read_expression();
+    curr_lineno = lineno;
+    return method(name, formals, return_type, expr);
+  }
+  if (tag != AST_ATTR)
+    malformed();
+  Symbol type_decl = symbol();
+  Expression init = read_expression();
+  curr_lineno = lineno;
+  return attr(name, type_decl, init);
+}
+
+Formal AstReader::read_formal()
+{
+  if (byte() != AST_FORMAL)
+    malformed();
+  int lineno = line();
+  Symbol name = symbol();
+  Symbol type_decl = symbol();
+  curr_lineno = lineno;
+  return formal(name, type_decl);
+}
+
+Case AstReader::read_case()
+{
+  if (byte() != AST_BRANCH)
+    malformed();
+  int lineno = line();
+  Symbol name = symbol();
+  Symbol type_decl = symbol();
+  Expression expr = read_expression();
+  curr_lineno = lineno;
+  return branch(name, type_decl, expr);
+}
+
+Expression AstReader::read_expression()
+{
+  unsigned char tag = byte();
+  int lineno = line();
+  Expression e1, e2, e3;
+  Symbol s1, s2;
+  Expressions actual;
+  Expression result = NULL;
+
+  switch (tag) {
+  case AST_ASSIGN:
+    s1 = symbol();
+    e1 = read_expression();
+    curr_lineno = lineno;
+    result = assign(s1, e1);
+    break;
+  case AST_STATIC_DISPATCH:
+    e1 = read_expression();
+    s1 = symbol();
+    s2 = symbol();
+    actual = read_list(nil_Expressions, single_Expressions, append_Expressions,
+                       &AstReader::read_expression);
+    curr_lineno = lineno;
+    result = static_dispatch(e1, s1, s2, actual);
+    break;
+  case AST_DISPATCH:
+    e1 = read_expression();
+    s1 = symbol();
+    actual = read_list(nil_Expressions, single_Expressions, append_Expressions,
+                       &AstReader::read_expression);
+    curr_lineno = lineno;
+    result = dispatch(e1, s1, actual);
+    break;
+  case AST_COND:
+    e1 = read_expression();
+    e2 = read_expression();
+    e3 = read_expression();
+    curr_lineno = lineno;
+    result = cond(e1, e2, e3);
+    break;
+  case AST_LOOP:
+    e1 = read_expression();
+    e2 = read_expression();
+    curr_lineno = lineno;
+    result = loop(e1, e2);
+    break;
+  case AST_TYPCASE: {
+    e1 = read_expression();
+    Cases cases = read_list(nil_Cases, single_Cases, append_Cases,
+                            &AstReader::read_case);
+    curr_lineno = lineno;
+    result = typcase(e1, cases);
+    break;
+  }
+  case AST_BLOCK:
+    actual = read_list(nil_Expressions, single_Expressions, append_Expressions,
+                       &AstReader::read_expression);
+    curr_lineno = lineno;
+    result = block(actual);
+    break;
+  case AST_LET:
+    s1 = symbol();
+    s2 = symbol();
+    e1 = read_expression();
+    e2 = read_expression();
+    curr_lineno = lineno;
+    result = let(s1, s2, e1, e2);
+    break;
+  case AST_PLUS:
+  case AST_SUB:
+  case AST_MUL:
+  case AST_DIVIDE:
+  case AST_LT:
+  case AST_EQ:
+  case AST_LEQ:
+    e1 = read_expression();
+    e2 = read_expression();
+    curr_lineno = lineno;
+    switch (tag) {
+    case AST_PLUS:   result = plus(e1, e2); break;
+    case AST_SUB:    result = sub(e1, e2); break;
+    case AST_MUL:    result = mul(e1, e2); break;
+    case AST_DIVIDE: result = divide(e1, e2); break;
+    case AST_LT:     result = lt(e1, e2); break;
+    case AST_EQ:     result = eq(e1, e2); break;
+    default:         result = leq(e1, e2); break;
+    }
+    break;
+  case AST_NEG:
+  case AST_COMP:
+  case AST_ISVOID:
+    e1 = read_expression();
+    curr_lineno = lineno;
+    if (tag == AST_NEG)
+      result = neg(e1);
+    else if (tag == AST_COMP)
+      result = comp(e1);
+    else
+      result = isvoid(e1);
+    break;
+  case AST_INT:
+    s1 = symbol();
+    curr_lineno = lineno;
+    result = int_const(s1);
+    break;
+  case AST_BOOL: {
+    unsigned char b = byte();
+    if (b > 1)
+      malformed();
+    curr_lineno = lineno;
+    result = bool_const(b);
+    break;
+  }
+  case AST_STRING:
+    s1 = symbol();
+    curr_lineno = lineno;
+    result = string_const(s1);
+    break;
+  case AST_NEW:
+    s1 = symbol();
+    curr_lineno = lineno;
+    result = new_(s1);
+    break;
+  case AST_NO_EXPR:
+    curr_lineno = lineno;
+    result = no_expr();
+    break;
+  case AST_OBJECT:
+    s1 = symbol();
+    curr_lineno = lineno;
+    result = object(s1);
+    break;
+  default:
+    malformed();
+  }
+  return result->set_type(symbol());
+}
+
+bool ast_binary_input(FILE *f)
+{
+  int c = getc(f);
+  if (c == EOF)
+    return false;
+  ungetc(c, f);
+  return c == AST_BINARY_MAGIC[0];
+}
+
+Program ast_binary_read(FILE *f)
+{
+  struct stat st;
+  int fd = fileno(f);
+  char *data = NULL;
+  size_t size = 0;
+  bool mapped = false;
+
+  // A regular file is mapped whole; anything else (a pipe from semant)
+  // is read into memory.
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void *m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m != MAP_FAILED) {
+      data = (char *) m;
+      size = st.st_size;
+      mapped = true;
+    }
+  }
+  if (!mapped) {
+    size_t capacity = 1 << 16;
+    data = (char *) malloc(capacity);
+    size_t n;
+    while (data != NULL && (n = fread(data + size, 1, capacity - size, f)) > 0) {
+      size += n;
+      if (size == capacity)
+        data = (char *) realloc(data, capacity *= 2);
+    }
+    if (data == NULL) {
+      cerr << "Out of memory reading binary AST" << endl;
+      exit(1);
+    }
+  }
+
+  // The tree keeps only Symbols, which own copies of their strings, so
+  // the input can be released as soon as it is read.
+  Program result = AstReader(data, size).read_program();
+  if (mapped)
+    munmap(data, size);
+  else
+    free(data);
+  return result;
+}
+
+Class_ ast_binary_read_class(const std::string &data)
+{
+  return AstReader(data.data(), data.size()).read_single_class();
+}
@@ -0,0 +1,206 @@
+//
+// coolgen.cc
+//
+// Writes a synthetic Cool program on stdout for benchmarking the phases
+// (see phase_bench.cc).  Each shape stresses one thing and grows linearly
+// with size:
+//
+//   deep     a chain of size classes, each inheriting from the last and
+//            overriding its methods
+//   wide     size classes that all inherit from one base
+//   let      a method whose body is size nested lets
+//   block    a method whose body is a block of size expressions
+//   chain    a method whose body is a chain of size dispatches,
+//            self.f().g().f()...
+//   strings  size distinct string literals, 50 to a method
+//   case     a case of size branches over size classes
+//   mixed    size/10 classes with attributes, methods and most kinds of
+//            expression, the way ordinary programs look
+//
+// Every program is type correct, so it gets through every phase.  The
+// parser's stack limits a let chain to about 1500 lets and a block to
+// about 5000 expressions.
+//
+// usage: coolgen shape size
+//
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static void main_class(const char *body)
+{
+  printf("class Main inherits IO {\n"
+         "  main() : Object {{\n"
+         "%s"
+         "    out_string(\"done\\n\");\n"
+         "  }};\n"
+         "};\n", body);
+}
+
+static void deep(int n)
+{
+  printf("class D0 inherits IO {\n"
+         "  a0 : Int <- 0;\n"
+         "  value() : Int { a0 };\n"
+         "  depth() : Int { 0 };\n"
+         "};\n");
+  for (int i = 1; i < n; i++)
+    printf("class D%d inherits D%d {\n"
+           "  a%d : Int <- %d;\n"
+           "  value() : Int { a%d + a%d };\n"
+           "  depth() : Int { %d };\n"
+           "};\n", i, i - 1, i, i, i, i - 1, i);
+  char body[128];
+  snprintf(body, sizeof body,
+           "    let d : D0 <- new D%d in out_int(d.depth());\n", n - 1);
+  main_class(body);
+}
+
+static void wide(int n)
+{
+  printf("class W inherits IO {\n"
+         "  id() : Int { 0 };\n"
+         "  name() : String { \"W\" };\n"
+         "};\n");
+  for (int i = 0; i < n; i++)
+    printf("class W%d inherits W {\n"
+           "  x%d : Int <- %d;\n"
+           "  id() : Int { x%d };\n"
+           "  name() : String { \"W%d\" };\n"
+           "  twice() : Int { id() + id() };\n"
+           "};\n", i, i, i, i, i);
+  main_class("    let w : W <- new W0 in out_int(w.id());\n");
+}
+
+static void let(int n)
+{
+  printf("class L {\n"
+         "  chain(x0 : Int) : Int {\n");
+  for (int i = 1; i <= n; i++)
+    printf("    let x%d : Int <- x%d + %d in\n", i, i - 1, i % 7);
+  printf("    x%d\n"
+         "  };\n"
+         "};\n", n);
+  main_class("    out_int(new L.chain(1));\n");
+}
+
+static void block(int n)
+{
+  printf("class B {\n"
+         "  x : Int;\n"
+         "  run() : Int {{\n");
+  for (int i = 0; i < n; i++)
+    switch (i % 3) {
+    case 0:  printf("    x <- x + %d;\n", i % 100); break;
+    case 1:  printf("    x <- x * 3 - x / 2;\n"); break;
+    default: printf("    if x < 0 then x <- ~x else x <- x fi;\n"); break;
+    }
+  printf("    x;\n"
+         "  }};\n"
+         "};\n");
+  main_class("    out_int(new B.run());\n");
+}
+
+static void chain(int n)
+{
+  printf("class H {\n"
+         "  f() : H { self };\n"
+         "  g() : SELF_TYPE { self };\n"
+         "  run() : H {\n"
+         "    self");
+  for (int i = 0; i < n; i++)
+    printf(i % 2 ? "\n      .g()" : "\n      .f()");
+  printf("\n"
+         "  };\n"
+         "};\n");
+  main_class("    new H.run();\n");
+}
+
+static void strings(int n)
+{
+  printf("class S inherits IO {\n");
+  for (int m = 0; m * 50 < n; m++) {
+    printf("  s%d() : Object {{\n", m);
+    for (int i = m * 50; i < n && i < (m + 1) * 50; i++)
+      printf("    \"string %d\\t of the strings shape\\n\";\n", i);
+    printf("    self;\n"
+           "  }};\n");
+  }
+  printf("};\n");
+  main_class("    new S.s0();\n");
+}
+
+static void case_(int n)
+{
+  for (int i = 0; i < n; i++)
+    printf("class K%d { };\n", i);
+  printf("class C {\n"
+         "  kind(o : Object) : Int {\n"
+         "    case o of\n");
+  for (int i = 0; i < n; i++)
+    printf("      k%d : K%d => %d;\n", i, i, i);
+  printf("      other : Object => ~1;\n"
+         "    esac\n"
+         "  };\n"
+         "};\n");
+  main_class("    out_int(new C.kind(new K0));\n");
+}
+
+static void mixed(int n)
+{
+  int classes = n / 10 > 0 ? n / 10 : 1;
+  for (int i = 0; i < classes; i++) {
+    char parent[16];
+    if (i % 8 == 0)
+      snprintf(parent, sizeof parent, "IO");
+    else
+      snprintf(parent, sizeof parent, "M%d", i - 1);
+    printf("class M%d inherits %s {\n", i, parent);
+    printf("  count%d : Int <- %d;\n"
+           "  name%d : String <- \"class M%d\";\n"
+           "  step(x : Int, flag : Bool) : Int {\n"
+           "    if flag then\n"
+           "      let y : Int <- x * 3 + count%d / 2 in\n"
+           "        { count%d <- y - ~x; name%d.length() + y; }\n"
+           "    else\n"
+           "      { while 0 < x loop x <- x - 1 pool; x; }\n"
+           "    fi\n"
+           "  };\n"
+           "  kind(o : Object) : String {\n"
+           "    case o of i : Int => \"int\"; s : String => s; "
+           "o2 : Object => \"object\"; esac\n"
+           "  };\n"
+           "  fresh() : SELF_TYPE { if isvoid self then new SELF_TYPE "
+           "else copy() fi };\n"
+           "};\n", i, i, i, i, i, i, i);
+  }
+  main_class("    out_int(new M0.step(3, true));\n");
+}
+
+static const struct {
+  const char *name;
+  void (*write)(int size);
+} shapes[] = {
+  { "deep", deep },
+  { "wide", wide },
+  { "let", let },
+  { "block", block },
+  { "chain", chain },
+  { "strings", strings },
+  { "case", case_ },
+  { "mixed", mixed },
+};
+
+int main(int argc, char *argv[]) {
+  int n = argc > 2 ? atoi(argv[2]) : 0;
+  for (size_t i = 0; argc > 2 && n > 0 && i < sizeof shapes / sizeof shapes[0]; i++)
+    if (strcmp(argv[1], shapes[i].name) == 0) {
+      shapes[i].write(n);
+      return 0;
+    }
+  fprintf(stderr, "usage: coolgen shape size\nshapes:");
+  for (size_t i = 0; i < sizeof shapes / sizeof shapes[0]; i++)
+    fprintf(stderr, " %s", shapes[i].name);
+  fprintf(stderr, "\n");
+  return 1;
+}
@@ -0,0 +1,149 @@
+//
+// parse_bench.cc
+//
+// Measures how parsing scales with threads.  A token stream for a
+// synthetic program of the requested number of classes, spread over
+// FILES files, is written to /tmp/parse_bench.tokens in the format the
+// lexer prints, read in once with read_token_files, and then parsed by
+// parse_files on 1, 2, 4, ... threads, up to the number of hardware
+// threads or the number given.  Each run parses the whole stream rounds
+// times so that the times are long enough to compare.
+//
+// usage: parse_bench [classes [rounds [threads]]]
+//
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <thread>
+#include "cool-parse.h"
+#include "parse-context.h"
+
+FILE *token_file;
+int curr_lineno;
+const char *curr_filename = "<stdin>";
+extern Classes parse_results;  // the classes of the last parse
+
+extern int yy_flex_debug;
+
+#define FILES 32
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Print the tokens of one line: its number followed by the tokens, each
+// either a quoted character, a name or a name and a value.
+static void line(FILE *f, int &lineno, const char *tokens)
+{
+  lineno++;
+  for (const char *p = tokens; *p != '\0'; ) {
+    const char *end = p;
+    while (*end != '\0' && *end != '|')
+      end++;
+    fprintf(f, "#%d %.*s\n", lineno, (int) (end - p), p);
+    p = *end == '|' ? end + 1 : end;
+  }
+}
+
+// A class with attributes, methods and most kinds of expression, as
+// tokens.  The tokens of each line are separated by '|'.
+static void write_class(FILE *f, int &lineno, int n)
+{
+  char buf[256];
+  snprintf(buf, sizeof buf,
+           "CLASS|TYPEID C%d|INHERITS|TYPEID IO|'{'", n);
+  line(f, lineno, buf);
+  line(f, lineno, "OBJECTID count|':'|TYPEID Int|ASSIGN|INT_CONST 0|';'");
+  line(f, lineno, "OBJECTID name|':'|TYPEID String|ASSIGN|"
+                  "STR_CONST \"parse\\tbench\\n\"|';'");
+  line(f, lineno, "OBJECTID step|'('|OBJECTID x|':'|TYPEID Int|','|"
+                  "OBJECTID flag|':'|TYPEID Bool|')'|':'|TYPEID Int|'{'");
+  line(f, lineno, "IF|OBJECTID flag|'='|BOOL_CONST true|THEN");
+  line(f, lineno, "LET|OBJECTID y|':'|TYPEID Int|ASSIGN|OBJECTID x|'*'|"
+                  "INT_CONST 3|'+'|OBJECTID count|'/'|INT_CONST 2|IN");
+  line(f, lineno, "'{'|OBJECTID count|ASSIGN|OBJECTID y|'-'|'~'|OBJECTID x|"
+                  "';'|OBJECTID out_string|'('|OBJECTID name|')'|';'|"
+                  "OBJECTID y|';'|'}'");
+  line(f, lineno, "ELSE");
+  line(f, lineno, "WHILE|NOT|OBJECTID x|LE|INT_CONST 0|LOOP|OBJECTID x|"
+                  "ASSIGN|OBJECTID x|'-'|INT_CONST 1|POOL");
+  line(f, lineno, "FI|'}'|';'");
+  line(f, lineno, "OBJECTID kind|'('|OBJECTID o|':'|TYPEID Object|')'|':'|"
+                  "TYPEID String|'{'");
+  line(f, lineno, "CASE|OBJECTID o|OF|OBJECTID i|':'|TYPEID Int|DARROW|"
+                  "STR_CONST \"int\"|';'|OBJECTID s|':'|TYPEID String|DARROW|"
+                  "STR_CONST \"string\"|';'|ESAC|'}'|';'");
+  line(f, lineno, "OBJECTID fresh|'('|')'|':'|TYPEID SELF_TYPE|'{'|IF|ISVOID|"
+                  "OBJECTID self|THEN|NEW|TYPEID SELF_TYPE|ELSE|OBJECTID self|"
+                  "'@'|TYPEID IO|'.'|OBJECTID copy|'('|')'|FI|'}'|';'");
+  line(f, lineno, "'}'|';'");
+}
+
+static void write_tokens(const char *path, int classes)
+{
+  FILE *f = fopen(path, "w");
+  if (f == NULL) {
+    fprintf(stderr, "Cannot create %s\n", path);
+    exit(1);
+  }
+  for (int i = 0; i < FILES; i++) {
+    int lineno = 0;
+    fprintf(f, "#name \"part%02d.cl\"\n", i);
+    for (int n = i; n < classes; n += FILES)
+      write_class(f, lineno, n);
+  }
+  fclose(f);
+}
+
+static int parse(const std::vector<TokenFile> &files, int threads, int rounds)
+{
+  int classes = 0;
+  for (int r = 0; r < rounds; r++) {
+    int errors;
+    if (parse_files(files, threads, &errors) == NULL) {
+      fprintf(stderr, "The token stream has syntax errors\n");
+      exit(1);
+    }
+    classes += parse_results->len();
+  }
+  return classes;
+}
+
+int main(int argc, char *argv[]) {
+  int classes = argc > 1 ? atoi(argv[1]) : 800;
+  int rounds = argc > 2 ? atoi(argv[2]) : 50;
+  int max_threads = argc > 3 ? atoi(argv[3]) : std::thread::hardware_concurrency();
+  const char *path = "/tmp/parse_bench.tokens";
+  if (max_threads < 1)
+    max_threads = 1;
+
+  yy_flex_debug = 0;
+  write_tokens(path, classes);
+  token_file = fopen(path, "r");
+  std::vector<TokenFile> files;
+  read_token_files(files);
+  fclose(token_file);
+  long tokens = 0;
+  for (size_t i = 0; i < files.size(); i++)
+    tokens += files[i].tokens.size();
+
+  parse(files, 1, 1);
+  double base = 0;
+  for (int threads = 1; ; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+    double start = seconds();
+    int parsed = parse(files, threads, rounds);
+    double elapsed = seconds() - start;
+    if (threads == 1)
+      base = elapsed;
+    printf("%2d threads: %d classes in %d files, %ld tokens, %d rounds in %.3f s, "
+           "%.0f classes/s, %.2f M tokens/s, speedup %.2f\n",
+           threads, classes, (int) files.size(), tokens, rounds, elapsed,
+           parsed / elapsed, tokens * rounds / elapsed / 1e6, base / elapsed);
+    if (threads == max_threads)
+      break;
+  }
+  return 0;
+}
@@ -9,6 +9,7 @@
 //  parser-phase.cc
 //
 //  Reads a COOL token stream from a file and builds the abstract syntax tree.
+//  With -j, the files in the stream are parsed in parallel.
 //
 //////////////////////////////////////////////////////////////////////////////
 
@@ -18,6 +19,8 @@
 #include "cool-tree.h"
 #include "utilities.h"  // for fatal_error
 #include "cool-parse.h"
+#include "parse-context.h"
+#include "phase-timer.h"
 
 //
 // These globals keep everything working.
@@ -31,16 +34,34 @@ const char *curr_filename = "<stdin>";
 
 extern int omerrs;             // a count of lex and parse errors
 
-extern int cool_yyparse();
+extern int parallel_jobs;       // parse the files on this many threads
 void handle_flags(int argc, char *argv[]);
 
 int main(int argc, char *argv[]) {
     handle_flags(argc, argv);
-    cool_yyparse();
+    if (parallel_jobs > 0) {
+	std::vector<TokenFile> files;
+	PhaseTimer read_phase("token read");
+	read_token_files(files);
+	read_phase.end();
+	PhaseTimer parse_phase("parsing");
+	ast_root = parse_files(files, parallel_jobs, &omerrs);
+	parse_phase.end();
+    } else {
+	// the tokens are read as they are parsed
+	PhaseTimer parse_phase("parsing");
+	ParseContext ctx(curr_filename, curr_lineno);
+	cool_yyparse(&ctx);
+	ast_root = ctx.program;
+	parse_results = ctx.classes;
+	omerrs = ctx.errors;
+	parse_phase.end();
+    }
     if (omerrs != 0) {
 	cerr << "Compilation halted due to lex and parse errors\n";
 	exit(1);
     }
+    PhaseTimer write_phase("AST write");
     ast_root->dump_with_types(cout,0);
     return 0;
 }
@@ -0,0 +1,261 @@
+//
+// phase_bench.cc
+//
+// Times one phase of the compiler on the programs coolgen writes, at four
+// sizes of each shape (each twice the last), and reports the time, the
+// throughput in source lines per second and how the time scales: the
+// exponent k in time ~ size^k between each size and the one before, which
+// is 1 for a phase that is linear in its input.  Exponents well above 1
+// are marked.
+//
+// The input of the phase is made once per program by running the phases
+// before it (the upstream commands, in order); the phase itself is then
+// run runs times and the fastest run is kept.  The lexer is given the
+// program's file name, every other phase reads its input on stdin.  Each
+// command is run by /bin/sh, so it may have flags.
+//
+// The times can be written to a file (-o) and compared against such a
+// file from an earlier build (-b): any time more than ratio times its
+// baseline is reported as a regression and the exit status is 1.  Times
+// under 5 ms are too noisy to compare.
+//
+// usage: phase_bench [-g coolgen] [-s scale] [-r runs] [-o results]
+//                    [-b baseline] [-x ratio]
+//                    phase command [upstream-command ...]
+//
+// where phase is lexer, parser, semant or cgen.
+//
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <map>
+#include <string>
+
+#define CL_FILE "/tmp/phase_bench.cl"
+#define INPUT_FILE "/tmp/phase_bench.in"
+#define NOISE_MS 5.0
+
+static const struct {
+  const char *name;
+  int size;             // the smallest size; the largest is eight times it
+} shapes[] = {
+  { "deep", 125 },
+  { "wide", 500 },
+  { "let", 150 },
+  { "block", 500 },
+  { "chain", 500 },
+  { "strings", 2000 },
+  { "case", 250 },
+  { "mixed", 2000 },
+};
+
+#define SHAPES ((int) (sizeof shapes / sizeof shapes[0]))
+#define SIZES 4
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage()
+{
+  fprintf(stderr,
+          "usage: phase_bench [-g coolgen] [-s scale] [-r runs] [-o results]\n"
+          "                   [-b baseline] [-x ratio]\n"
+          "                   phase command [upstream-command ...]\n");
+  exit(1);
+}
+
+static void run_or_die(const std::string &cmd)
+{
+  if (system(cmd.c_str()) != 0) {
+    fprintf(stderr, "Failed: %s\n", cmd.c_str());
+    exit(1);
+  }
+}
+
+struct Run {
+  double wall, cpu;     // ms
+  long peak_rss;        // KB
+};
+
+//
+// Run cmd with stdin from in (unless it is NULL) and stdout to /dev/null.
+// wait4 gives the CPU time and peak RSS of the phase alone, since the
+// shell execs it.
+//
+static Run time_command(const std::string &cmd, const char *in)
+{
+  std::string line = "exec " + cmd;
+  Run r;
+  double start = seconds();
+  pid_t pid = fork();
+  if (pid == 0) {
+    if (in != NULL) {
+      int fd = open(in, O_RDONLY);
+      if (fd < 0 || dup2(fd, 0) < 0)
+        _exit(127);
+    }
+    int out = open("/dev/null", O_WRONLY);
+    if (out < 0 || dup2(out, 1) < 0)
+      _exit(127);
+    execl("/bin/sh", "sh", "-c", line.c_str(), (char *) NULL);
+    _exit(127);
+  }
+  int status;
+  struct rusage ru;
+  if (pid < 0 || wait4(pid, &status, 0, &ru) != pid ||
+      !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    fprintf(stderr, "Failed: %s%s%s\n", cmd.c_str(), in ? " < " : "",
+            in ? in : "");
+    exit(1);
+  }
+  r.wall = (seconds() - start) * 1e3;
+  r.cpu = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3 +
+          (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-3;
+  r.peak_rss = ru.ru_maxrss;
+  return r;
+}
+
+static long count_lines(const char *path)
+{
+  FILE *f = fopen(path, "r");
+  long lines = 0;
+  int c;
+  if (f == NULL)
+    return 0;
+  while ((c = getc(f)) != EOF)
+    if (c == '\n')
+      lines++;
+  fclose(f);
+  return lines;
+}
+
+static std::string key(const char *shape, int size)
+{
+  char buf[64];
+  snprintf(buf, sizeof buf, "%s %d", shape, size);
+  return buf;
+}
+
+static void read_baseline(const char *path, std::map<std::string, double> &base)
+{
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    fprintf(stderr, "Cannot open baseline %s\n", path);
+    exit(1);
+  }
+  char shape[32];
+  int size;
+  double wall;
+  while (fscanf(f, "%31s %d %lf", shape, &size, &wall) == 3)
+    base[key(shape, size)] = wall;
+  fclose(f);
+}
+
+int main(int argc, char *argv[]) {
+  const char *coolgen = "./coolgen";
+  const char *results = NULL, *baseline = NULL;
+  int scale = 1, runs = 3;
+  double ratio = 1.25;
+  int c;
+  while ((c = getopt(argc, argv, "g:s:r:o:b:x:")) != -1)
+    switch (c) {
+    case 'g': coolgen = optarg; break;
+    case 's': scale = atoi(optarg); break;
+    case 'r': runs = atoi(optarg); break;
+    case 'o': results = optarg; break;
+    case 'b': baseline = optarg; break;
+    case 'x': ratio = atof(optarg); break;
+    default: usage();
+    }
+  static const char *phases[] = { "lexer", "parser", "semant", "cgen" };
+  int phase = -1;
+  for (int i = 0; optind < argc && i < 4; i++)
+    if (strcmp(argv[optind], phases[i]) == 0)
+      phase = i;
+  // the phase's own command and one for each phase before it
+  if (phase < 0 || argc - optind != phase + 2 || scale < 1 || runs < 1)
+    usage();
+  std::string command = argv[optind + 1];
+  std::string upstream;
+  for (int i = 0; i < phase; i++)
+    upstream += std::string(i == 0 ? "" : " | ") + argv[optind + 2 + i] +
+                (i == 0 ? " " CL_FILE : "");
+
+  std::map<std::string, double> base;
+  if (baseline != NULL)
+    read_baseline(baseline, base);
+  FILE *out = NULL;
+  if (results != NULL && (out = fopen(results, "w")) == NULL) {
+    fprintf(stderr, "Cannot create %s\n", results);
+    return 1;
+  }
+
+  printf("%s: %s, fastest of %d runs\n", phases[phase], command.c_str(), runs);
+  printf("%-8s %7s %8s %9s %9s %9s %10s %7s%s\n", "shape", "size", "lines",
+         "wall ms", "cpu ms", "peak KB", "lines/s", "scaling",
+         baseline != NULL ? "  vs base" : "");
+  int regressions = 0;
+  for (int s = 0; s < SHAPES; s++) {
+    double last = 0;
+    for (int k = 0; k < SIZES; k++) {
+      int size = shapes[s].size * scale << k;
+      char gen[256];
+      snprintf(gen, sizeof gen, "%s %s %d > " CL_FILE, coolgen,
+               shapes[s].name, size);
+      run_or_die(gen);
+      if (phase > 0)
+        run_or_die(upstream + " > " INPUT_FILE);
+      std::string cmd = phase == 0 ? command + " " CL_FILE : command;
+      Run best;
+      for (int r = 0; r < runs; r++) {
+        Run t = time_command(cmd, phase == 0 ? NULL : INPUT_FILE);
+        if (r == 0 || t.wall < best.wall)
+          best = t;
+      }
+      long lines = count_lines(CL_FILE);
+
+      char scaling[16] = "";
+      if (k > 0 && last > 0)
+        snprintf(scaling, sizeof scaling, "%.2f%s", log2(best.wall / last),
+                 log2(best.wall / last) > 1.5 && best.wall > NOISE_MS ? "!" : " ");
+      printf("%-8s %7d %8ld %9.1f %9.1f %9ld %10.0f %7s", shapes[s].name,
+             size, lines, best.wall, best.cpu, best.peak_rss,
+             lines / (best.wall * 1e-3), scaling);
+      if (baseline != NULL) {
+        std::map<std::string, double>::iterator b =
+          base.find(key(shapes[s].name, size));
+        if (b != base.end() && b->second > 0) {
+          double r = best.wall / b->second;
+          bool slower = r > ratio && best.wall > NOISE_MS;
+          printf("  %7.2f%s", r, slower ? " regression" : "");
+          regressions += slower;
+        }
+      }
+      printf("\n");
+      fflush(stdout);
+      if (out != NULL)
+        fprintf(out, "%s %d %.3f\n", shapes[s].name, size, best.wall);
+      last = best.wall;
+    }
+  }
+  if (out != NULL)
+    fclose(out);
+  unlink(CL_FILE);
+  unlink(INPUT_FILE);
+  if (regressions > 0) {
+    printf("%d regression%s over %.2fx the baseline\n", regressions,
+           regressions == 1 ? "" : "s", ratio);
+    return 1;
+  }
+  return 0;
+}
@@ -1,9 +1,12 @@
 #include <stdio.h>
 #include "cool-tree.h"
+#include "ast-binary.h"
+#include "phase-timer.h"
 
 extern Program ast_root;      // root of the abstract syntax tree
 FILE *ast_file = stdin;       // we read the AST from standard input
 extern int ast_yyparse(void); // entry point to the AST parser
+extern int binary_ast;        // -b: write the typed AST in binary form
 
 int cool_yydebug;     // not used, but needed to link with handle_flags
 int curr_lineno;
@@ -13,8 +16,18 @@ void handle_flags(int argc, char *argv[]);
 
 int main(int argc, char *argv[]) {
   handle_flags(argc,argv);
+  PhaseTimer read_phase("AST read");
   ast_yyparse();
+  read_phase.end();
+  PhaseTimer semant_phase("semant");
   ast_root->semant();
-  ast_root->dump_with_types(cout,0);
+  semant_phase.end();
+  PhaseTimer write_phase("AST write");
+  if (binary_ast) {
+    AstWriter writer;
+    ast_root->dump_binary(writer);
+    writer.finish(cout);
+  } else
+    ast_root->dump_with_types(cout,0);
 }
 
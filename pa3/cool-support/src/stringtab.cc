@@ -19,9 +19,21 @@ template class StringTable<StringEntry>;
 template class StringTable<IntEntry>;
 
 Entry::Entry(const char *s, int l, int i) : len(l), index(i) {
-  str = new char [len+1];
-  strncpy(str, s, len);
-  str[len] = '\0';
+  str = stringtab_arena.copy_string(s, len);
+  hash = hash_string(str, len);
+}
+
+//
+// 32-bit FNV-1a.  Cheap enough to run on every token the lexer interns.
+//
+unsigned Entry::hash_string(const char *s, int len)
+{
+  unsigned h = 2166136261u;
+  for (int i = 0; i < len; i++) {
+    h ^= (unsigned char) s[i];
+    h *= 16777619u;
+  }
+  return h;
 }
 
 int Entry::equal_string(const char *string, int length) const
@@ -74,6 +86,9 @@ StringEntry::StringEntry(const char *s, int l, int i) : Entry(s,l,i) { }
 IdEntry::IdEntry(const char *s, int l, int i) : Entry(s,l,i) { }
 IntEntry::IntEntry(const char *s, int l, int i) : Entry(s,l,i) { }
 
+Arena stringtab_arena;
+std::mutex stringtab_lock;
+std::atomic<long> stringtab_interns(0);
 IdTable idtable;
 IntTable inttable;
 StrTable stringtable;
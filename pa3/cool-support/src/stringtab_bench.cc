@@ -0,0 +1,115 @@
+//
+// stringtab_bench.cc
+//
+// Interns a few million identifiers into idtable the way the lexer does
+// (every occurrence goes through add_string, most of them repeats) and
+// reports the rate, the number of blocks the string table arena took
+// from malloc and the peak resident set size.  Before the arena every new
+// entry cost three heap allocations (its string, the Entry and the list
+// node), so the block count is compared against three per entry.
+//
+// The same occurrences are then split between 2, 4, ... threads interning
+// into a fresh table at once, and the table is renumbered in the order a
+// single thread would have used; every entry must end up with the index
+// it has in idtable.
+//
+// usage: stringtab_bench [distinct-identifiers [occurrences [threads]]]
+//
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+#include "cool-parse.h"
+#include "stringtab.h"
+
+YYSTYPE cool_yylval;           // Not compiled with parser, so must define this.
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int distinct;
+
+// the identifier for occurrence i; a cheap scramble so repeats are not
+// adjacent
+static void name(char *buf, int i)
+{
+  snprintf(buf, 32, "id_%d", (int) ((i * 2654435761u) % distinct));
+}
+
+// Occurrences [0, occurrences) split between threads, interned into t.
+static double intern_parallel(IdTable *t, int occurrences, int threads)
+{
+  std::vector<std::thread> pool;
+  double start = seconds();
+  for (int k = 0; k < threads; k++)
+    pool.push_back(std::thread([=]() {
+      char buf[32];
+      for (int i = k; i < occurrences; i += threads) {
+        name(buf, i);
+        t->add_string(buf);
+      }
+    }));
+  for (auto &th : pool)
+    th.join();
+  return seconds() - start;
+}
+
+int main(int argc, char *argv[]) {
+  distinct = argc > 1 ? atoi(argv[1]) : 200000;
+  int occurrences = argc > 2 ? atoi(argv[2]) : 4000000;
+  int max_threads = argc > 3 ? atoi(argv[3]) : std::thread::hardware_concurrency();
+  char buf[32];
+
+  double start = seconds();
+  for (int i = 0; i < occurrences; i++) {
+    name(buf, i);
+    idtable.add_string(buf);
+  }
+  double elapsed = seconds() - start;
+
+  // every identifier must still come back in index order
+  int count = 0;
+  for (int i = idtable.first(); idtable.more(i); i = idtable.next(i)) {
+    IdEntryP e = idtable.lookup(i);
+    assert(idtable.lookup_string(e->get_string()) == e);
+    count++;
+  }
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  printf("%d add_string calls, %d distinct: %.3f s, %.2f M/s\n",
+         occurrences, count, elapsed, occurrences / elapsed / 1e6);
+  printf("arena: %ld blocks for %ld bytes (was %d allocations), "
+         "peak RSS %ld KB\n",
+         stringtab_arena.block_count(), stringtab_arena.bytes_allocated(),
+         3 * count, usage.ru_maxrss);
+
+  for (int threads = 2; threads <= (max_threads > 2 ? max_threads : 2); threads *= 2) {
+    IdTable *t = new IdTable;
+    double parallel = intern_parallel(t, occurrences, threads);
+
+    double renumber_start = seconds();
+    t->renumber_begin(0);
+    for (int i = 0; i < occurrences; i++) {
+      name(buf, i);
+      t->renumber(t->lookup_string(buf));
+    }
+    t->renumber_end();
+    double renumber = seconds() - renumber_start;
+
+    for (int i = t->first(); t->more(i); i = t->next(i))
+      assert(idtable.lookup(i)->equal_string(t->lookup(i)->get_string(),
+                                             t->lookup(i)->get_len()));
+    printf("%d threads: %.3f s, %.2f M/s, speedup %.2f; renumbered in %.3f s\n",
+           threads, parallel, occurrences / parallel / 1e6, elapsed / parallel,
+           renumber);
+  }
+  return 0;
+}
@@ -14,11 +14,14 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include "tree.h"
+#include "arena.h"
 
 #define yylineno curr_lineno;
 
 extern int yylineno;
 
+thread_local int *node_lineno = &curr_lineno;
+
 ///////////////////////////////////////////////////////////////////////////
 //
 // tree_node::tree_node
@@ -28,7 +31,29 @@ extern int yylineno;
 ///////////////////////////////////////////////////////////////////////////
 tree_node::tree_node()
 {
-    line_number = yylineno;
+    line_number = *node_lineno;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// node_alloc, tree_node::operator new
+//
+// Nodes and the arrays of lists are never freed, so instead of one malloc
+// each they are carved out of an arena.  Each thread has its own, so
+// parse threads need no locking; the blocks outlive the thread, and with
+// it its nodes.
+//
+///////////////////////////////////////////////////////////////////////////
+static thread_local Arena node_arena;
+
+void *node_alloc(size_t size)
+{
+    return node_arena.allocate(size, alignof(tree_node));
+}
+
+void *tree_node::operator new(size_t size)
+{
+    return node_alloc(size);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -14,6 +14,7 @@
 //      fatal_error            print an error message and exit
 //      print_escaped_string   print a string showing escape characters
 //      print_cool_token       print a cool token and its semantic value
+//                             (by default cool_yylval, on cerr)
 //      dump_cool_token        dump a readable token representation
 //
 ///////////////////////////////////////////////////////////////////////////////
@@ -122,44 +123,49 @@ const char *cool_token_to_string(int tok)
   }
 }
 
-void print_cool_token(int tok)
+void print_cool_token(ostream& out, int tok, YYSTYPE yylval)
 {
 
-  cerr << cool_token_to_string(tok);
+  out << cool_token_to_string(tok);
 
   switch (tok) {
   case (STR_CONST):
-    cerr << " = ";
-    cerr << " \"";
-    print_escaped_string(cerr, cool_yylval.symbol->get_string());
-    cerr << "\"";
+    out << " = ";
+    out << " \"";
+    print_escaped_string(out, yylval.symbol->get_string());
+    out << "\"";
 #ifdef CHECK_TABLES
-    stringtable.lookup_string(cool_yylval.symbol->get_string());
+    stringtable.lookup_string(yylval.symbol->get_string());
 #endif
     break;
   case (INT_CONST):
-    cerr << " = " << cool_yylval.symbol;
+    out << " = " << yylval.symbol;
 #ifdef CHECK_TABLES
-    inttable.lookup_string(cool_yylval.symbol->get_string());
+    inttable.lookup_string(yylval.symbol->get_string());
 #endif
     break;
   case (BOOL_CONST):
-    cerr << (cool_yylval.boolean ? " = true" : " = false");
+    out << (yylval.boolean ? " = true" : " = false");
     break;
   case (TYPEID):
   case (OBJECTID):
-    cerr << " = " << cool_yylval.symbol;
+    out << " = " << yylval.symbol;
 #ifdef CHECK_TABLES
-    idtable.lookup_string(cool_yylval.symbol->get_string());
+    idtable.lookup_string(yylval.symbol->get_string());
 #endif
     break;
   case (ERROR): 
-    cerr << " = ";
-    print_escaped_string(cerr, cool_yylval.error_msg);
+    out << " = ";
+    print_escaped_string(out, yylval.error_msg);
     break;
   }
 }
 
+void print_cool_token(int tok)
+{
+  print_cool_token(cerr, tok, cool_yylval);
+}
+
 // dump the token in format readable by the sceond phase token lexer
 void dump_cool_token(ostream& out, int lineno, int token, YYSTYPE yylval) {
     out << "#" << lineno << " " << cool_token_to_string(token);
@@ -167,26 +173,26 @@ void dump_cool_token(ostream& out, int lineno, int token, YYSTYPE yylval) {
     switch (token) {
     case (STR_CONST):
 	out << " \"";
-	print_escaped_string(out, cool_yylval.symbol->get_string());
+	print_escaped_string(out, yylval.symbol->get_string());
 	out << "\"";
 #ifdef CHECK_TABLES
-	stringtable.lookup_string(cool_yylval.symbol->get_string());
+	stringtable.lookup_string(yylval.symbol->get_string());
 #endif
 	break;
     case (INT_CONST):
-	out << " " << cool_yylval.symbol;
+	out << " " << yylval.symbol;
 #ifdef CHECK_TABLES
-	inttable.lookup_string(cool_yylval.symbol->get_string());
+	inttable.lookup_string(yylval.symbol->get_string());
 #endif
 	break;
     case (BOOL_CONST):
-	out << (cool_yylval.boolean ? " true" : " false");
+	out << (yylval.boolean ? " true" : " false");
 	break;
     case (TYPEID):
     case (OBJECTID):
-	out << " " << cool_yylval.symbol;
+	out << " " << yylval.symbol;
 #ifdef CHECK_TABLES
-	idtable.lookup_string(cool_yylval.symbol->get_string());
+	idtable.lookup_string(yylval.symbol->get_string());
 #endif
 	break;
     case (ERROR): 
@@ -195,12 +201,12 @@ void dump_cool_token(ostream& out, int lineno, int token, YYSTYPE yylval) {
         // if we see an "empty" string here, we can safely assume the
         // lexer is reporting an occurrance of an illegal NUL in the
         // input stream
-        if (cool_yylval.error_msg[0] == 0) {
+        if (yylval.error_msg[0] == 0) {
           out << " \"\\000\"";
         }
         else {
           out << " \"";
-          print_escaped_string(out, cool_yylval.error_msg);
+          print_escaped_string(out, yylval.error_msg);
           out << "\"";
           break;
         }
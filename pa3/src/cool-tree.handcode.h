@@ -9,7 +9,6 @@
 #include "cool.h"
 #include "stringtab.h"
 #include "symtab.h"
-#include <functional>
 #define yylineno curr_lineno;
 extern int yylineno;
 
@@ -48,86 +47,78 @@ typedef Cases_class *Cases;
 
 using namespace cool;
 
-#define Program_EXTRAS                          \
-virtual void semant() = 0;			\
-virtual void dump_with_types(ostream&, int) = 0; 
+#include "semant-tree.handcode.h"
+
+class AstWriter;
 
-class attr_class;
-class method_class;
+#define Program_EXTRAS                          \
+virtual void dump_with_types(ostream&, int) = 0; \
+virtual void dump_binary(AstWriter&) = 0;	\
+SEMANT_Program_EXTRAS
 
 #define program_EXTRAS                          \
-void semant();     				\
-void dump_with_types(ostream&, int);            
+void dump_with_types(ostream&, int);            \
+void dump_binary(AstWriter&);	\
+SEMANT_program_EXTRAS
 
 #define Class__EXTRAS                   \
 virtual Symbol get_filename() = 0;      \
 virtual Symbol get_name() = 0; 			\
 virtual Symbol get_parent() = 0;		\
-virtual Features get_features() = 0;	\
 virtual void dump_with_types(ostream&,int) = 0;	\
-virtual void check_type_annotate(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0;
+virtual void dump_binary(AstWriter&) = 0;	\
+SEMANT_Class__EXTRAS
 
 
 #define class__EXTRAS                                 	\
 Symbol get_filename() { return filename; }             	\
 Symbol get_name() { return name; }             			\
 Symbol get_parent() { return parent; }             		\
-Features get_features() { return features; }             \
 void dump_with_types(ostream&,int);                  	\
-void check_type_annotate(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
+void dump_binary(AstWriter&);                        	\
+SEMANT_class__EXTRAS
 
 
 #define Feature_EXTRAS                                      \
 virtual void dump_with_types(ostream&,int) = 0; 			\
-virtual Symbol get_name() = 0;								\
-virtual Symbol get_type() = 0;								\
-virtual void check_error(std::function<ostream&()>) = 0;	\
-virtual bool check_redefined(std::function<ostream&()>, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0; \
-virtual void add_to_table(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0;								\
-virtual void check_type_annotate(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0;
+virtual void dump_binary(AstWriter&) = 0;					\
+SEMANT_Feature_EXTRAS
 
 #define Feature_SHARED_EXTRAS                                   \
 void dump_with_types(ostream&,int);    							\
-void check_type_annotate(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
+void dump_binary(AstWriter&);    								\
+SEMANT_Feature_SHARED_EXTRAS
 
 #define method_EXTRAS                               \
-Symbol get_name() {	return name;	}				\
-Symbol get_type() {	return return_type;	}			\
-Formals get_formals() {	return formals;	}			\
-void check_error(std::function<ostream&()>);		\
-bool check_redefined(std::function<ostream&()>, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *); \
-void add_to_table(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
+SEMANT_method_EXTRAS
 
 #define attr_EXTRAS                                 \
-Symbol get_name() {	return name; }					\
-Symbol get_type() {	return type_decl; }				\
-void check_error(std::function<ostream&()>);		\
-bool check_redefined(std::function<ostream&()>, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *); \
-void add_to_table(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
+SEMANT_attr_EXTRAS
 
 
 #define Formal_EXTRAS                              \
 virtual void dump_with_types(ostream&,int) = 0;		\
+virtual void dump_binary(AstWriter&) = 0;			\
 virtual Symbol get_name() = 0;						\
-virtual Symbol get_type() = 0;						
+SEMANT_Formal_EXTRAS
 
 #define formal_EXTRAS                           \
 void dump_with_types(ostream&,int);				\
+void dump_binary(AstWriter&);					\
 Symbol get_name() {	return name; }				\
-Symbol get_type() {	return type_decl; }			
+SEMANT_formal_EXTRAS
 
 
 #define Case_EXTRAS                             \
 virtual void dump_with_types(ostream& ,int) = 0;	\
-virtual Symbol get_name() = 0;						\
-virtual Symbol get_type() = 0;						\
-virtual Expression get_expr() = 0;
+virtual void dump_binary(AstWriter&) = 0;			\
+SEMANT_Case_EXTRAS
 
 #define branch_EXTRAS                                 \
 void dump_with_types(ostream& ,int);			\
-Symbol get_name() { return name; }						\
-Symbol get_type() { return type_decl; }						\
-Expression get_expr() { return expr; }
+void dump_binary(AstWriter&);				\
+Expression get_expr() { return expr; }		\
+SEMANT_branch_EXTRAS
 
 
 #define Expression_EXTRAS                    \
@@ -135,12 +126,14 @@ Symbol type;                                 \
 Symbol get_type() { return type; }           \
 Expression set_type(Symbol s) { type = s; return this; } \
 virtual void dump_with_types(ostream&,int) = 0;  \
+virtual void dump_binary(AstWriter&) = 0;    \
 void dump_type(ostream&, int);               \
 Expression_class() { type = (Symbol) NULL; }	\
-virtual Expression check_type_annotate(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0;
+SEMANT_Expression_EXTRAS
 
 #define Expression_SHARED_EXTRAS           \
 void dump_with_types(ostream&,int); 		\
-Expression check_type_annotate(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
+void dump_binary(AstWriter&);       		\
+SEMANT_Expression_SHARED_EXTRAS
 
 #endif
@@ -0,0 +1,84 @@
+//
+// The members of the tree classes that semant adds, kept apart from the
+// rest of cool-tree.handcode.h so that a program with another phase's
+// members can add these too: coolc (pa4) has semant and cgen in one
+// program, sharing the tree.  Each SEMANT_x_EXTRAS goes at the end of
+// x_EXTRAS.
+
+#ifndef SEMANT_TREE_HANDCODE_H
+#define SEMANT_TREE_HANDCODE_H
+
+#include <functional>
+#include <vector>
+#include "symtab.h"
+
+using namespace cool;         // semant.cc uses SymbolTable unqualified
+
+class attr_class;
+class method_class;
+
+#define SEMANT_Program_EXTRAS                   \
+virtual void semant() = 0;
+
+#define SEMANT_program_EXTRAS                   \
+void semant();
+
+#define SEMANT_Class__EXTRAS                    \
+virtual Features get_features() = 0;	\
+virtual void check_type_annotate(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0;
+
+#define SEMANT_class__EXTRAS                    \
+Features get_features() { return features; }             \
+void check_type_annotate(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
+
+#define SEMANT_Feature_EXTRAS                                    \
+virtual Symbol get_name() = 0;								\
+virtual Symbol get_type() = 0;								\
+virtual void check_error(std::function<ostream&()>) = 0;	\
+virtual bool check_redefined(std::function<ostream&()>, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0; \
+virtual void add_to_table(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0;								\
+virtual void signature(ostream&, std::vector<Symbol>&) = 0;					\
+virtual void check_type_annotate(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0;
+
+#define SEMANT_Feature_SHARED_EXTRAS                             \
+void check_type_annotate(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
+
+#define SEMANT_method_EXTRAS                        \
+Symbol get_name() {	return name;	}				\
+Symbol get_type() {	return return_type;	}			\
+Formals get_formals() {	return formals;	}			\
+void check_error(std::function<ostream&()>);		\
+bool check_redefined(std::function<ostream&()>, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *); \
+void add_to_table(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *); \
+void signature(ostream&, std::vector<Symbol>&);
+
+#define SEMANT_attr_EXTRAS                          \
+Symbol get_name() {	return name; }					\
+Symbol get_type() {	return type_decl; }				\
+void check_error(std::function<ostream&()>);		\
+bool check_redefined(std::function<ostream&()>, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *); \
+void add_to_table(SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *); \
+void signature(ostream&, std::vector<Symbol>&);
+
+#define SEMANT_Formal_EXTRAS                       \
+virtual Symbol get_type() = 0;
+
+#define SEMANT_formal_EXTRAS                    \
+Symbol get_type() {	return type_decl; }
+
+#define SEMANT_Case_EXTRAS                      \
+virtual Symbol get_name() = 0;						\
+virtual Symbol get_type() = 0;						\
+virtual Expression get_expr() = 0;
+
+#define SEMANT_branch_EXTRAS                          \
+Symbol get_name() { return name; }						\
+Symbol get_type() { return type_decl; }
+
+#define SEMANT_Expression_EXTRAS             \
+virtual Expression check_type_annotate(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *) = 0;
+
+#define SEMANT_Expression_SHARED_EXTRAS    \
+Expression check_type_annotate(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
+
+#endif
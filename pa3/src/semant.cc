@@ -3,15 +3,27 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <ctype.h>
 #include <vector>
 #include <algorithm>
+#include <set>
+#include <sstream>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
 #include "semant.h"
 #include "utilities.h"
+#include "ast-binary.h"
+#include "class-cache.h"
+#include "phase-timer.h"
 
 using namespace cool;
 
 extern int semant_debug;
 extern char *curr_filename;
+extern char *cache_dir;
+extern int parallel_jobs;
 
 //////////////////////////////////////////////////////////////////////
 //
@@ -84,7 +96,60 @@ static void initialize_constants(void)
     val         = idtable.add_string("_val");
 }
 
+//
+// The types given to set_type are all symbols of idtable already (the
+// names in the tree and the constants above), so they are passed on as
+// they are and not interned again, which would cost a hash and a probe
+// per expression.  With DEBUG, check that they are.
+//
+static inline Symbol interned(Symbol type)
+{
+#ifdef DEBUG
+    assert(idtable.lookup(type->get_index()) == type);
+#endif
+    return type;
+}
+
 static ClassTable * classtable;
+static ClassCache * class_cache;
+
+//
+// What checking a run of features on one of several threads would have
+// done to the ClassTable (see check_type_annotate_parallel).  While a
+// thread has a log, semant_error, is_subclass and is_type_exist use it
+// instead.
+//
+struct CheckLog {
+    std::unique_ptr<std::ostringstream> messages;   // made at the first error
+    int errors;
+    std::vector<Symbol> entered;    // names is_subclass entered in the graph
+    std::vector<Symbol> missed;     // names is_type_exist did not find
+    CheckLog() : errors(0) { }
+};
+
+static thread_local CheckLog *check_log;
+
+//
+// A class type checked through the class cache: its key, the names it
+// refers to that are not in the graph, in the order add_dependencies
+// found them, and its error messages and their count, replayed from its
+// entry or written while checking it.  Only type names can be entered
+// into the graph, so a class whose undefined names are all object
+// names, which Cool spells in lower case, enters none.
+//
+struct CachedClass {
+    Class_ class_node;      // typed once found or checked
+    CacheKey key;
+    std::vector<Symbol> undefined;
+    bool undefined_type;    // some name in undefined is a type name
+    bool found;             // its entry was in the cache
+    bool checked;           // checked with others on threads
+    std::ostringstream messages;
+    int errors;
+    CachedClass(Class_ class_node, const char *kind)
+        : class_node(class_node), key(kind), undefined_type(false), found(false),
+          checked(false), errors(0) { }
+};
 
 void ClassTable::halt() {
     if (errors()) {
@@ -107,13 +172,40 @@ bool ClassTable::is_subclass(Symbol return_type, Symbol decl_type, Symbol self_n
     }
 }
 
+//
+// The walk up the graph this replaces entered return_type in the graph,
+// and No_class when it went past Object, whatever it returned; a name
+// that is not a class is then found by is_type_exist (and by the class
+// cache), so those entries are still made.
+//
 bool ClassTable::is_subclass(Symbol return_type, Symbol decl_type) {
-    Class_ class_node = graph[return_type];
+    int tag = get_tag(return_type);
+    if (tag < 0) {
+        enter(return_type);
+        return return_type == decl_type;
+    }
     if (return_type == decl_type)
         return true;
-    if (class_node == NULL)
-        return false;
-    return (is_subclass(class_node->get_parent(), decl_type));
+    int ancestor = get_tag(decl_type);
+    if (ancestor >= 0 && ancestor <= tag && tag <= max_child[ancestor])
+        return true;
+    if (!no_class_entered)
+        enter(No_class);
+    return decl_type == No_class;
+}
+
+// Enter a name that is not a class in the graph, or in the log of the
+// thread checking.
+void ClassTable::enter(Symbol name) {
+    if (check_log != NULL) {
+        std::vector<Symbol>& entered = check_log->entered;
+        if (find(entered.begin(), entered.end(), name) == entered.end())
+            entered.push_back(name);
+        return;
+    }
+    graph[name];
+    if (name == No_class)
+        no_class_entered = true;
 }
 
 Symbol ClassTable::get_lub(Symbol a, Symbol b) {
@@ -121,22 +213,45 @@ Symbol ClassTable::get_lub(Symbol a, Symbol b) {
         return b;
     else if (is_subclass(b, a))
         return a;
-    else 
-        return get_lub(graph[a]->get_parent(), b);
+    int ta = get_tag(a), tb = get_tag(b);
+    if (ta < 0 || tb < 0)
+        return Object;
+
+    // Lift the deeper class to the depth of the other, then both to just
+    // below their least common ancestor.
+    if (depth[ta] < depth[tb])
+        std::swap(ta, tb);
+    for (int k = ancestors.size() - 1; k >= 0; k--)
+        if (depth[ta] - (1 << k) >= depth[tb])
+            ta = ancestors[k][ta];
+    for (int k = ancestors.size() - 1; k >= 0; k--)
+        if (ancestors[k][ta] != ancestors[k][tb]) {
+            ta = ancestors[k][ta];
+            tb = ancestors[k][tb];
+        }
+    return tag_class[ancestors[0][ta]];
+}
+
+int ClassTable::get_tag(Symbol name) {
+    size_t index = name->get_index();
+    return index < class_tag.size() ? class_tag[index] : -1;
 }
 
 bool ClassTable::is_type_exist(Symbol type, Symbol filename, tree_node *t) {
     if (graph.find(type) == graph.end() && type != SELF_TYPE) { 
+        if (check_log != NULL) {
+            std::vector<Symbol>& entered = check_log->entered;
+            if (find(entered.begin(), entered.end(), type) != entered.end())
+                return true;
+            check_log->missed.push_back(type);
+        }
         return false;
     }
     return true;
 }
 
 bool ClassTable::is_method_exist(Symbol class_name, Symbol method_name, Symbol filename, tree_node *t) {
-    if(global_method_table[class_name]->lookup(method_name) == NULL) {
-        return false;
-    }
-    return true;
+    return get_method_class(class_name, method_name) != NULL;
 }
 
 std::map<Symbol, Class_> ClassTable::get_graph() {
@@ -151,18 +266,23 @@ SymbolTable<Symbol, method_class>* ClassTable::get_method_table(Symbol name) {
     return global_method_table[name];
 }
 
+// Looks the table up without entering class_name, so that threads may
+// call it at once; a name entered by is_subclass has no table.
 method_class* ClassTable::get_method_class(Symbol class_name, Symbol method_name) {
-    return global_method_table[class_name]->lookup(method_name);
+    auto it = global_method_table.find(class_name);
+    return it == global_method_table.end() ? NULL : it->second->lookup(method_name);
 }
 
-ClassTable::ClassTable(Classes classes) : semant_errors(0) , error_stream(cerr) {
+ClassTable::ClassTable(Classes classes) : no_class_entered(false), semant_errors(0) , error_stream(&cerr) {
 
     /* Fill this in */
     install_basic_classes();
     add_class_nodes(classes);
     set_uids();
     check_parent_vaild();
-    check_cycle();
+    check_cycle(classes);
+    if (!errors())
+        number_classes();
 }
 
 void ClassTable::add_class_nodes(Classes classes) {
@@ -204,12 +324,20 @@ void ClassTable::add_formals(Formals formals, SymbolTable<Symbol, attr_class> *a
 }
 
 void ClassTable::set_uids() {
-    int i = 0;
-    uid_table[No_class] = i++;
+    int max_index = No_class->get_index();
+    uid_class.push_back(No_class);
     for (auto iter = graph.begin(); iter != graph.end(); iter++) {
-        Symbol name = iter->first;
-        uid_table[name] = i++;
+        uid_class.push_back(iter->first);
+        max_index = std::max(max_index, iter->first->get_index());
     }
+    class_uid.assign(max_index + 1, -1);
+    for (size_t i = 0; i < uid_class.size(); i++)
+        class_uid[uid_class[i]->get_index()] = i;
+}
+
+int ClassTable::get_uid(Symbol name) {
+    size_t index = name->get_index();
+    return index < class_uid.size() ? class_uid[index] : -1;
 }
 
 void ClassTable::check_parent_vaild() {
@@ -227,48 +355,92 @@ void ClassTable::check_parent_vaild() {
     }
 }
 
-void ClassTable::check_cycle() {
-    // https://www.geeksforgeeks.org/detect-cycle-in-a-graph/
+//
+// Every class has one parent, so following the parents from a class
+// ends either at No_class (or an undefined class) or in a cycle.  A walk
+// stops at the first class an earlier walk reached, so each class is
+// visited once, and a walk that comes back to its own path has found a
+// cycle no earlier walk did: the classes from there to the end of the
+// path.  The classes on cycles are reported in program order; those that
+// only inherit from one are not.
+//
+void ClassTable::check_cycle(Classes classes) {
+    enum { UNSEEN, ON_PATH, DONE };
+    int num = uid_class.size();
+    std::vector<char> state(num, UNSEEN);
+    std::vector<bool> on_cycle(num, false);
+    std::vector<int> path;
+
+    for (int v = 1; v < num; v++) {
+        int u = v;
+        while (u > 0 && state[u] == UNSEEN) {
+            state[u] = ON_PATH;
+            path.push_back(u);
+            u = get_uid(graph[uid_class[u]]->get_parent());
+        }
+        if (u > 0 && state[u] == ON_PATH)
+            for (size_t i = find(path.begin(), path.end(), u) - path.begin(); i < path.size(); i++)
+                on_cycle[path[i]] = true;
+        for (int w : path)
+            state[w] = DONE;
+        path.clear();
+    }
 
-    int num = graph.size();
-    bool *visited = new bool[num];
-    bool *recStack = new bool[num];
-    for(int i = 0; i < num; i++)
-    {
-        visited[i] = false;
-        recStack[i] = false;
+    for (auto i = classes->first(); classes->more(i); i = classes->next(i)) {
+        Class_ class_node = classes->nth(i);
+        Symbol name = class_node->get_name();
+        int u = get_uid(name);
+        if (u > 0 && on_cycle[u] && graph[name] == class_node)
+            semant_error(class_node) << "Class " << name << ", or an ancestor of " << name
+                                     << ", is involved in an inheritance cycle.\n";
     }
- 
-    for(int i = 0; i < num; i++)
-        if (check_cycle_util(i, visited, recStack)) {
-            semant_error() << "The inheritance graph is not acyclic.\n";
-            return;
-        }
 }
 
-bool ClassTable::check_cycle_util(int v, bool visited[], bool *recStack)
-{
-    if(visited[v] == false)
-    {
-        visited[v] = true;
-        recStack[v] = true;
-
-        if(graph.find(find_symbol_by_uid(v)) != graph.end()) {
-            int i = uid_table[graph[find_symbol_by_uid(v)]->get_parent()];
-            if ( !visited[i] && check_cycle_util(i, visited, recStack) )
-                return true;
-            else if (recStack[i])
-                return true;
+//
+// Give the classes their tags, depths and ancestors; the graph must be a
+// tree rooted at Object.  The walk keeps its own stack, since a chain of
+// classes may be far deeper than the C++ stack.
+//
+void ClassTable::number_classes() {
+    std::map<Symbol, std::vector<Symbol> > children;
+    int max_index = 0;
+    for (auto iter = graph.begin(); iter != graph.end(); iter++) {
+        if (iter->first != Object)
+            children[iter->second->get_parent()].push_back(iter->first);
+        max_index = std::max(max_index, iter->first->get_index());
+    }
+    class_tag.assign(max_index + 1, -1);
+
+    std::vector<int> parent;
+    std::vector<std::pair<Symbol, size_t> > path;    // a class and its next child
+    auto enter = [&](Symbol name) {
+        int tag = tag_class.size();
+        class_tag[name->get_index()] = tag;
+        tag_class.push_back(name);
+        max_child.push_back(tag);
+        depth.push_back(path.size());
+        parent.push_back(path.empty() ? tag : class_tag[path.back().first->get_index()]);
+        path.push_back(std::make_pair(name, 0));
+    };
+    enter(Object);
+    while (!path.empty()) {
+        std::vector<Symbol>& kids = children[path.back().first];
+        if (path.back().second < kids.size())
+            enter(kids[path.back().second++]);
+        else {
+            max_child[class_tag[path.back().first->get_index()]] = tag_class.size() - 1;
+            path.pop_back();
         }
     }
-    recStack[v] = false;
-    return false;
-}
 
-Symbol ClassTable::find_symbol_by_uid(int uid) {
-    for (auto it = uid_table.begin(); it != uid_table.end(); ++it)
-        if (it->second == uid)
-            return it->first;
+    ancestors.push_back(parent);
+    for (size_t k = 1; ((size_t) 1 << k) < tag_class.size(); k++) {
+        const std::vector<int>& up = ancestors[k - 1];
+        std::vector<int> next(up.size());
+        for (size_t t = 0; t < up.size(); t++)
+            next[t] = up[up[t]];
+        ancestors.push_back(next);
+    }
 }
 
 void ClassTable::install_basic_classes() {
@@ -385,6 +557,7 @@ void ClassTable::install_basic_classes() {
 ///////////////////////////////////////////////////////////////////
 
 void ClassTable::traverse_gather_all_decls() {
+    gather_inherited_decls();
     for (auto iter = graph.begin(); iter != graph.end(); iter++) { //traverse
         gather_all_decls(iter->second);
     }
@@ -397,29 +570,40 @@ void ClassTable::check_main_exist() {
     }
 }
 
+//
+// A class sees all the features of its ancestors, erroneous or not, and
+// its own that are not in error.  The first part is the same for every
+// subclass, so it is built once per class, in preorder (tag order), as
+// the parent's map with the class's own features added.  The maps share
+// everything they have in common, so a chain of n classes needs O(n)
+// space and not O(n^2).
+//
+void ClassTable::gather_inherited_decls() {
+    for (size_t t = 0; t < tag_class.size(); t++) {
+        SymbolTable<Symbol, attr_class> attr_table(t == 0 ? SymbolMap<Symbol, attr_class>() : all_attrs[ancestors[0][t]]);
+        SymbolTable<Symbol, method_class> method_table(t == 0 ? SymbolMap<Symbol, method_class>() : all_methods[ancestors[0][t]]);
+        attr_table.enterscope();
+        method_table.enterscope();
+        add_features(graph[tag_class[t]], &attr_table, &method_table);
+        all_attrs.push_back(attr_table.flatten());
+        all_methods.push_back(method_table.flatten());
+    }
+}
+
 void ClassTable::gather_all_decls(Class_ c) {
     Symbol name = c->get_name();
-    SymbolTable<Symbol, attr_class> *attr_table = new SymbolTable<Symbol, attr_class>();
-    SymbolTable<Symbol, method_class> *method_table = new SymbolTable<Symbol, method_class>();
+    int parent = get_tag(c->get_parent());
+    SymbolTable<Symbol, attr_class> *attr_table =
+        parent < 0 ? new SymbolTable<Symbol, attr_class>() : new SymbolTable<Symbol, attr_class>(all_attrs[parent]);
+    SymbolTable<Symbol, method_class> *method_table =
+        parent < 0 ? new SymbolTable<Symbol, method_class>() : new SymbolTable<Symbol, method_class>(all_methods[parent]);
 
-    if(name != Object) gather_parent_decls(graph[c->get_parent()], attr_table, method_table);
     gather_my_decls(c, attr_table, method_table);
 
     global_attr_table[name] = attr_table;
     global_method_table[name] = method_table;
 }
 
-void ClassTable::gather_parent_decls(Class_ c, SymbolTable<Symbol, attr_class> *attr_table, SymbolTable<Symbol, method_class> *method_table) {
-    if(c->get_name() == Object) {
-        attr_table->enterscope();
-        method_table->enterscope();
-    }
-    else {
-        gather_parent_decls(graph[c->get_parent()], attr_table, method_table);
-    }
-    add_features(c, attr_table, method_table);
-}
-
 void ClassTable::gather_my_decls(Class_ c, SymbolTable<Symbol, attr_class> *attr_table, SymbolTable<Symbol, method_class> *method_table) {
     Symbol name = c->get_name();
 
@@ -542,12 +726,125 @@ void method_class::add_to_table(SymbolTable<Symbol, attr_class> *attr_table, Sym
 //
 ///////////////////////////////////////////////////////////////////
 
-void ClassTable::traverse_type_check_annotate(Classes classes) {
+Classes ClassTable::traverse_type_check_annotate(Classes classes) {
+    if (class_cache != NULL) {
+        Classes checked = check_type_annotate_cached(classes, std::max(parallel_jobs, 1));
+        if (semant_debug)
+            cerr << "Class cache: " << class_cache->hit_count() << " hits, "
+                 << class_cache->miss_count() << " misses" << endl;
+        return checked;
+    }
+    if (parallel_jobs > 1) {
+        std::vector<Class_> all;
+        for(auto i = classes->first(); classes->more(i); i = classes->next(i))
+            all.push_back(classes->nth(i));
+        check_type_annotate_parallel(all, parallel_jobs, NULL);
+        return classes;
+    }
     for(auto i = classes->first(); classes->more(i); i = classes->next(i)) {
         Symbol name = classes->nth(i)->get_name();
         Class_ class_node = classes->nth(i);
         class_node->check_type_annotate(global_attr_table[name], global_method_table[name]);
     }
+    return classes;
+}
+
+//
+// With -j, the classes are type checked on that many threads.  By now
+// the graph and the declaration tables are complete, and checking a
+// class reads them and writes only its own subtree, except for two
+// things: it reports errors, and is_subclass enters names that are not
+// classes into the graph, where is_type_exist then finds them.  So each
+// item of work, a class or a run of FEATURES_PER_ITEM features of a
+// large one, is checked against a log of its own (a CheckLog), and the
+// threads claim the items in turn, as the parser's threads claim files.
+// The logs are then replayed in program order.  An item that did not
+// find a name an earlier item entered would have found it on one thread,
+// so it is checked again, in order on this thread; that takes an
+// undefined type, and is rare.  The output is the same as without -j.
+// With -C, the classes that were not found in the cache are checked this
+// way, and results[i] takes the messages of classes[i] and their count.
+//
+#define FEATURES_PER_ITEM 16
+
+struct CheckItem {
+    size_t index;                           // the class's in classes
+    Class_ class_node;
+    int first, last;                        // its features first to last-1
+    SymbolMap<Symbol, attr_class> attrs;    // the class's attribute table
+    CheckLog log;
+};
+
+void ClassTable::check_features(Class_ class_node, int first, int last, const SymbolMap<Symbol, attr_class>& attrs) {
+    SymbolTable<Symbol, attr_class> attr_table(attrs);
+    SymbolTable<Symbol, method_class> *method_table = global_method_table.find(class_node->get_name())->second;
+    Features features = class_node->get_features();
+    for(int i = first; i < last; i++)
+        features->nth(i)->check_type_annotate(class_node, &attr_table, method_table);
+}
+
+void ClassTable::check_type_annotate_parallel(const std::vector<Class_>& classes, int threads, const std::vector<CachedClass *> *results) {
+    std::vector<CheckItem> items;
+    for(size_t i = 0; i < classes.size(); i++) {
+        Class_ class_node = classes[i];
+        SymbolMap<Symbol, attr_class> attrs = global_attr_table[class_node->get_name()]->flatten();
+        int n = class_node->get_features()->len();
+        for(int first = 0; first < n; first += FEATURES_PER_ITEM) {
+            items.push_back(CheckItem());
+            CheckItem& item = items.back();
+            item.index = i;
+            item.class_node = class_node;
+            item.first = first;
+            item.last = std::min(n, first + FEATURES_PER_ITEM);
+            item.attrs = attrs;
+        }
+    }
+
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        for (;;) {
+            size_t i = next++;
+            if (i >= items.size())
+                return;
+            check_log = &items[i].log;
+            check_features(items[i].class_node, items[i].first, items[i].last, items[i].attrs);
+            check_log = NULL;
+        }
+    };
+    if (threads > (int) items.size())
+        threads = items.size();
+    std::vector<std::thread> pool;
+    for(int j = 1; j < threads; j++)
+        pool.push_back(std::thread(work));
+    work();
+    for(auto &t : pool)
+        t.join();
+
+    ostream *saved_stream = error_stream;
+    for(CheckItem& item : items) {
+        CachedClass *result = results ? (*results)[item.index] : NULL;
+        int saved_errors = semant_errors;
+        if (result)
+            error_stream = &result->messages;
+        CheckLog& log = item.log;
+        bool stale = false;
+        for(Symbol s : log.missed)
+            stale = stale || graph.find(s) != graph.end();
+        if (stale)
+            check_features(item.class_node, item.first, item.last, item.attrs);
+        else {
+            if (log.messages)
+                *error_stream << log.messages->str();
+            semant_errors += log.errors;
+            for(Symbol s : log.entered)
+                enter(s);
+        }
+        if (result) {
+            result->errors += semant_errors - saved_errors;
+            semant_errors = saved_errors;
+            error_stream = saved_stream;
+        }
+    }
 }
 
 void class__class::check_type_annotate(SymbolTable<Symbol, attr_class> *attr_table, SymbolTable<Symbol, method_class> *method_table) {
@@ -603,7 +900,7 @@ Expression assign_class::check_type_annotate(Class_ class_node, SymbolTable<Symb
 
     if(name == self) {
         classtable->semant_error(class_node->get_filename(), this) << "Cannot assign to 'self'.\n";
-        return set_type(idtable.add_string(expr_type->get_string()));    
+        return set_type(interned(expr_type));    
     }
 
     if (!classtable->is_subclass(expr_type, decl_type)) {
@@ -612,14 +909,14 @@ Expression assign_class::check_type_annotate(Class_ class_node, SymbolTable<Symb
         return set_type(Object);
     }
     else {
-        return set_type(idtable.add_string(expr_type->get_string()));
+        return set_type(interned(expr_type));
     }
 }
 
 Expression let_class::check_type_annotate(Class_ class_node, SymbolTable<Symbol, attr_class> *attr_table, SymbolTable<Symbol, method_class> *method_table) {
     if (identifier == self) {
         classtable->semant_error(class_node->get_filename(), this) << "'self' cannot be bound in a 'let' expression.\n";
-        return set_type(idtable.add_string(type_decl->get_string()));
+        return set_type(interned(type_decl));
     }
 
     init = init->check_type_annotate(class_node, attr_table, method_table);
@@ -638,7 +935,7 @@ Expression let_class::check_type_annotate(Class_ class_node, SymbolTable<Symbol,
     attr_table->addid(identifier, new attr_class(identifier, type_decl, init));
     body = body->check_type_annotate(class_node, attr_table, method_table);
     attr_table->exitscope();
-    return set_type(idtable.add_string(body->get_type()->get_string()));
+    return set_type(interned(body->get_type()));
 }
 
 Expression static_dispatch_class::check_type_annotate(Class_ class_node, SymbolTable<Symbol, attr_class> *attr_table, SymbolTable<Symbol, method_class> *method_table) {
@@ -681,12 +978,12 @@ Expression static_dispatch_class::check_type_annotate(Class_ class_node, SymbolT
     }
     Symbol return_type = classtable->get_method_class(type_name, name)->get_type();    
     if(type_name == SELF_TYPE) {
-        return set_type(idtable.add_string(return_type->get_string()));
+        return set_type(interned(return_type));
     }
     else {
         return return_type == SELF_TYPE ? 
-            set_type(idtable.add_string(expr_type->get_string())) : 
-            set_type(idtable.add_string(return_type->get_string()));
+            set_type(interned(expr_type)) : 
+            set_type(interned(return_type));
     }
     
 }
@@ -724,13 +1021,13 @@ Expression dispatch_class::check_type_annotate(Class_ class_node, SymbolTable<Sy
         }
     }
     Symbol return_type = classtable->get_method_class(expr_type, name)->get_type();
-    if(expr->check_type_annotate(class_node, attr_table, method_table)->get_type() == SELF_TYPE) {
-        return set_type(idtable.add_string(return_type->get_string()));
+    if(expr->get_type() == SELF_TYPE) {
+        return set_type(interned(return_type));
     }
     else {
         return return_type == SELF_TYPE ? 
-            set_type(idtable.add_string(expr_type->get_string())) : 
-            set_type(idtable.add_string(return_type->get_string()));
+            set_type(interned(expr_type)) : 
+            set_type(interned(return_type));
     }
 }
 
@@ -750,7 +1047,7 @@ Expression cond_class::check_type_annotate(Class_ class_node, SymbolTable<Symbol
                 then_exp->get_type() == SELF_TYPE ? attr_table->lookup(self)->get_type() : then_exp->get_type(), 
                 else_exp->get_type() == SELF_TYPE ? attr_table->lookup(self)->get_type() : else_exp->get_type());
             
-            return set_type(idtable.add_string(lub_type->get_string()));
+            return set_type(interned(lub_type));
         }
     }
 }
@@ -798,7 +1095,7 @@ Expression typcase_class::check_type_annotate(Class_ class_node, SymbolTable<Sym
             closest_ancestor = classtable->get_lub(closest_ancestor, expr->get_type());
         }
     }
-    return set_type(idtable.add_string(closest_ancestor->get_string()));
+    return set_type(interned(closest_ancestor));
 }
 
 Expression loop_class::check_type_annotate(Class_ class_node, SymbolTable<Symbol, attr_class> *attr_table, SymbolTable<Symbol, method_class> *method_table) {
@@ -815,7 +1112,7 @@ Expression block_class::check_type_annotate(Class_ class_node, SymbolTable<Symbo
     for (auto i = body->first(); body->more(i); i = body->next(i)) {
         expr = body->nth(i)->check_type_annotate(class_node, attr_table, method_table);
     }
-    return set_type(idtable.add_string(expr->get_type()->get_string()));
+    return set_type(interned(expr->get_type()));
 }
 
 Expression plus_class::check_type_annotate(Class_ class_node, SymbolTable<Symbol, attr_class> *attr_table, SymbolTable<Symbol, method_class> *method_table) {
@@ -957,7 +1254,7 @@ Expression object_class::check_type_annotate(Class_ class_node, SymbolTable<Symb
         return set_type(SELF_TYPE);
     }
     else {
-        return set_type(idtable.add_string(attr_table->lookup(name)->get_type()->get_string()));
+        return set_type(interned(attr_table->lookup(name)->get_type()));
     }
 }
 
@@ -967,7 +1264,196 @@ Expression new__class::check_type_annotate(Class_ class_node, SymbolTable<Symbol
         return set_type(Object);
     }
     else 
-        return set_type(idtable.add_string(type_name->get_string()));
+        return set_type(interned(type_name));
+}
+
+////////////////////////////////////////////////////////////////////
+//
+//   Class cache
+//
+//   With -C, each class is type checked through the class cache (see
+//   class-cache.h).  Checking a class depends on its own AST and, through
+//   the attribute and method tables and is_subclass, on the signatures of
+//   the classes it names, of the classes those signatures name in turn,
+//   and of all their ancestors.  The key covers exactly these, so editing
+//   a method body invalidates only its own class, and changing a
+//   signature only the classes that can see it.  An entry holds the typed
+//   class, its error messages and the undefined names that checking
+//   entered into the graph; a hit replays all three.
+//
+///////////////////////////////////////////////////////////////////
+
+static const char *semant_cache_kind = "semant " __DATE__ " " __TIME__;
+
+void attr_class::signature(ostream& s, std::vector<Symbol>& types) {
+    s << "attr " << name << " : " << type_decl << ";";
+    types.push_back(type_decl);
+}
+
+void method_class::signature(ostream& s, std::vector<Symbol>& types) {
+    s << "method " << name << "(";
+    for(auto i = formals->first(); formals->more(i); i = formals->next(i)) {
+        Formal formal = formals->nth(i);
+        s << formal->get_name() << " : " << formal->get_type() << ",";
+        types.push_back(formal->get_type());
+    }
+    s << ") : " << return_type << ";";
+    types.push_back(return_type);
+}
+
+// Add to key the signature of every class reachable from names.  Names
+// that are not in the graph are added as undefined and listed in
+// undefined, in the order they are found.
+void ClassTable::add_dependencies(CacheKey& key, const std::vector<Symbol>& names, std::vector<Symbol>& undefined) {
+    std::vector<Symbol> work(names);
+    std::set<Symbol> seen(names.begin(), names.end());
+    for(size_t i = 0; i < work.size(); i++) {
+        std::ostringstream sig;
+        sig << work[i];
+        auto it = graph.find(work[i]);
+        if (work[i] == No_class || work[i] == SELF_TYPE) {
+            // is_subclass may enter these, but nothing asks whether they
+            // are in the graph, so the key does not say.
+        }
+        else if (it == graph.end()) {
+            sig << " undefined";
+            undefined.push_back(work[i]);
+        }
+        else if (it->second == NULL) {
+            // entered by is_subclass while checking an earlier class
+            sig << " entered";
+        }
+        else {
+            Class_ c = it->second;
+            std::vector<Symbol> types;
+            types.push_back(c->get_parent());
+            sig << " inherits " << c->get_parent() << " {";
+            Features features = c->get_features();
+            for(auto j = features->first(); features->more(j); j = features->next(j))
+                features->nth(j)->signature(sig, types);
+            sig << "}";
+            for(Symbol t : types)
+                if (seen.insert(t).second)
+                    work.push_back(t);
+        }
+        key.add(sig.str());
+    }
+}
+
+//
+// An entry is a header line, "errors n k1 ... kn length", where the k's
+// are the positions in undefined of the names checking entered into the
+// graph, then length bytes of error messages and then the typed class in
+// binary form.
+//
+void ClassTable::lookup_cached(CachedClass& c) {
+    AstWriter writer;
+    std::ostringstream ast;
+    c.class_node->dump_binary(writer);
+    writer.finish(ast);
+
+    c.key.add(ast.str());
+    add_dependencies(c.key, writer.used_symbols(AST_ID_SYMBOL), c.undefined);
+    for(Symbol s : c.undefined)
+        c.undefined_type = c.undefined_type || isupper(s->get_string()[0]);
+
+    std::string entry;
+    if (class_cache->lookup(c.key, entry)) {
+        std::istringstream in(entry);
+        int errors = 0;
+        size_t n = 0, k, length = 0;
+        std::vector<Symbol> entered;
+        in >> errors >> n;
+        for(size_t i = 0; i < n && in >> k && k < c.undefined.size(); i++)
+            entered.push_back(c.undefined[k]);
+        in >> length;
+        if (in.get() == '\n' && entered.size() == n && (size_t) in.tellg() + length <= entry.size()) {
+            size_t start = in.tellg();
+            for(Symbol s : entered)
+                graph[s] = NULL;
+            c.messages.write(entry.data() + start, length);
+            c.errors = errors;
+            c.class_node = ast_binary_read_class(entry.substr(start + length));
+            c.found = true;
+        }
+    }
+}
+
+void ClassTable::store_cached(CachedClass& c) {
+    std::ostringstream out;
+    out << c.errors;
+    std::vector<size_t> entered;
+    for(size_t i = 0; i < c.undefined.size(); i++)
+        if (graph.find(c.undefined[i]) != graph.end())
+            entered.push_back(i);
+    out << " " << entered.size();
+    for(size_t i : entered)
+        out << " " << i;
+    std::string messages = c.messages.str();
+    out << " " << messages.size() << "\n" << messages;
+    AstWriter typed;
+    c.class_node->dump_binary(typed);
+    typed.finish(out);
+    class_cache->store(c.key, out.str());
+}
+
+//
+// The classes are looked up in order, and their messages go out in
+// order.  With -j, a class that was not found but names no undefined
+// type enters nothing into the graph, so the keys of the classes after
+// it do not wait for it to be checked, and what it finds in the graph
+// does not depend on them.  Such classes are checked together on the
+// threads (check_type_annotate_parallel) when a class that does name
+// one is reached, or at the end.
+//
+Classes ClassTable::check_type_annotate_cached(Classes classes, int threads) {
+    Classes checked = nil_Classes();
+    std::deque<CachedClass> pending;       // looked up, not yet reported
+    for(auto i = classes->first(); classes->more(i); i = classes->next(i)) {
+        pending.emplace_back(classes->nth(i), semant_cache_kind);
+        CachedClass& c = pending.back();
+        lookup_cached(c);
+        if (!c.found && (threads == 1 || c.undefined_type))
+            checked = report_cached(checked, pending, threads);
+    }
+    return report_cached(checked, pending, threads);
+}
+
+//
+// Check the classes in pending that were not found, store their entries
+// and append all of pending, in order, to checked.
+//
+Classes ClassTable::report_cached(Classes checked, std::deque<CachedClass>& pending, int threads) {
+    std::vector<Class_> batch;
+    std::vector<CachedClass *> results;
+    for(CachedClass& c : pending)
+        if (!c.found && threads > 1 && !c.undefined_type) {
+            c.checked = true;
+            batch.push_back(c.class_node);
+            results.push_back(&c);
+        }
+    if (!batch.empty())
+        check_type_annotate_parallel(batch, threads, &results);
+
+    for(CachedClass& c : pending) {
+        if (!c.found && !c.checked) {
+            Symbol name = c.class_node->get_name();
+            ostream *saved_stream = error_stream;
+            int saved_errors = semant_errors;
+            error_stream = &c.messages;
+            c.class_node->check_type_annotate(global_attr_table[name], global_method_table[name]);
+            error_stream = saved_stream;
+            c.errors = semant_errors - saved_errors;
+            semant_errors = saved_errors;
+        }
+        if (!c.found)
+            store_cached(c);
+        *error_stream << c.messages.str();
+        semant_errors += c.errors;
+        checked = append_Classes(checked, single_Classes(c.class_node));
+    }
+    pending.clear();
+    return checked;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -992,8 +1478,7 @@ ostream& ClassTable::semant_error(Class_ c)
 
 ostream& ClassTable::semant_error(Symbol filename, tree_node *t)
 {
-    error_stream << filename << ":" << t->get_line_number() << ": ";
-    return semant_error();
+    return semant_error() << filename << ":" << t->get_line_number() << ": ";
 }
 
 ostream& ClassTable::semant_error_callback(Symbol filename, tree_node *t)
@@ -1003,8 +1488,14 @@ ostream& ClassTable::semant_error_callback(Symbol filename, tree_node *t)
 
 ostream& ClassTable::semant_error()                  
 {                                                 
+    if (check_log != NULL) {
+        if (!check_log->messages)
+            check_log->messages.reset(new std::ostringstream);
+        check_log->errors++;
+        return *check_log->messages;
+    }
     semant_errors++;                            
-    return error_stream;
+    return *error_stream;
 } 
 
 /*   This is the entry point to the semantic checker.
@@ -1023,14 +1514,22 @@ ostream& ClassTable::semant_error()
 void program_class::semant()
 {
     initialize_constants();
+    if (cache_dir != NULL)
+        class_cache = new ClassCache(cache_dir);
 
     /* ClassTable constructor may do some semantic analysis */
+    PhaseTimer graph_phase("class graph");
     classtable = new ClassTable(classes);
     classtable->halt();
+    graph_phase.end();
 
     /* some semantic analysis code may go here */
+    PhaseTimer decls_phase("decl gathering");
     classtable->traverse_gather_all_decls();
-    classtable->traverse_type_check_annotate(classes);
+    decls_phase.end();
+    PhaseTimer check_phase("type checking");
+    classes = classtable->traverse_type_check_annotate(classes);
+    check_phase.end();
     classtable->halt();
 }
 
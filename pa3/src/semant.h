@@ -8,6 +8,8 @@
 #include "symtab.h"
 #include "list.h"
 #include <map>
+#include <vector>
+#include <deque>
 #include <functional>
 
 #define TRUE 1
@@ -15,6 +17,8 @@
 
 class ClassTable;
 typedef ClassTable *ClassTableP;
+class CacheKey;
+struct CachedClass;
 
 // This is a structure that may be used to contain the semantic
 // information such as the inheritance graph.  You may use it or not as
@@ -26,23 +30,57 @@ private:
   std::map<Symbol, SymbolTable<Symbol, attr_class> *> global_attr_table;
   std::map<Symbol, SymbolTable<Symbol, method_class> *> global_method_table;
   std::map<Symbol, Class_> graph;
-  std::map<Symbol, int> uid_table;
+  bool no_class_entered;      // is_subclass has entered No_class in graph
+
+  // The classes numbered densely (their uids) in graph order, after
+  // No_class, which is 0: uid_class maps a uid to the class's name, and
+  // class_uid a name's index in idtable to its uid (-1 if not a class).
+  std::vector<Symbol> uid_class;
+  std::vector<int> class_uid;
+
+  // The inheritance tree numbered in preorder, as CgenClassTable numbers
+  // it: the subclasses of the class with tag t have the tags t+1 to
+  // max_child[t].  class_tag is indexed by a name's index in idtable and
+  // is -1 for a name that is not a class; the rest are indexed by tag.
+  // ancestors[k][t] is the 2^k'th ancestor of t (Object's for the root).
+  std::vector<int> class_tag;
+  std::vector<Symbol> tag_class;
+  std::vector<int> max_child;
+  std::vector<int> depth;
+  std::vector<std::vector<int> > ancestors;
+
+  // Every feature of the class with tag t and of its ancestors, each
+  // map built over its parent's (see gather_inherited_decls).
+  std::vector<SymbolMap<Symbol, attr_class> > all_attrs;
+  std::vector<SymbolMap<Symbol, method_class> > all_methods;
+
   int semant_errors;
-  ostream& error_stream;
+  ostream *error_stream;
 
   void install_basic_classes();
   void add_class_nodes(Classes);
   void set_uids();
   void check_main_exist();
   void check_parent_vaild();
-  void check_cycle();
-  bool check_cycle_util(int v, bool visited[], bool *recStack);
-  Symbol find_symbol_by_uid(int);
+  void check_cycle(Classes);
+  int get_uid(Symbol);
+  void number_classes();
+  int get_tag(Symbol);
+  void enter(Symbol);
 
   void add_features(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
   void add_not_error_features(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
   void add_not_error_feature(Symbol, Feature, std::function<ostream&()>,  SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
 
+  void add_dependencies(CacheKey&, const std::vector<Symbol>&, std::vector<Symbol>&);
+  void lookup_cached(CachedClass&);
+  void store_cached(CachedClass&);
+  Classes check_type_annotate_cached(Classes, int);
+  Classes report_cached(Classes, std::deque<CachedClass>&, int);
+
+  void check_features(Class_, int, int, const SymbolMap<Symbol, attr_class>&);
+  void check_type_annotate_parallel(const std::vector<Class_>&, int, const std::vector<CachedClass *> *);
+
 public:
   ClassTable(Classes);
   int errors() { return semant_errors; }
@@ -53,11 +91,11 @@ public:
 
   void halt();
   
-  void gather_parent_decls(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
+  void gather_inherited_decls();
   void gather_my_decls(Class_, SymbolTable<Symbol, attr_class> *, SymbolTable<Symbol, method_class> *);
   void gather_all_decls(Class_);
   void traverse_gather_all_decls();
-  void traverse_type_check_annotate(Classes);
+  Classes traverse_type_check_annotate(Classes);
 
   SymbolTable<Symbol, attr_class>* get_attr_table(Symbol);
   SymbolTable<Symbol, method_class>* get_method_table(Symbol);
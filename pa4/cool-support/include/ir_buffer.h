@@ -0,0 +1,45 @@
+#ifndef IR_BUFFER_H
+#define IR_BUFFER_H
+
+/* IRBuffer
+ * A stream buffer for emitting generated code.  Everything written through
+ * an ostream attached to an IRBuffer is copied into one large buffer that
+ * is reused for the whole run, and each time the buffer fills (or the
+ * stream is flushed) its contents go out in a single write(2) on the file
+ * descriptor.  Compared to ofstream or cout this avoids the per-insertion
+ * locale and sentry overhead of the default buffers, and the small writes
+ * they make.
+ *
+ *	IRBuffer buf(fd);
+ *	ostream o(&buf);
+ *	o << ...;
+ *	o.flush();	// also done by the destructor
+ */
+
+#include <ios>
+#include <streambuf>
+#include <stddef.h>
+
+class IRBuffer : public std::streambuf {
+	private:
+		int fd;
+		char *buf;
+		size_t size;
+		std::streamoff written;	/* bytes already passed to write(2) */
+		bool failed;
+		bool drain();
+	protected:
+		int overflow(int c);
+		std::streamsize xsputn(const char *s, std::streamsize n);
+		int sync();
+		/* supports tellp() only */
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+				 std::ios_base::openmode which);
+	public:
+		enum { DEFAULT_SIZE = 1 << 20 };
+		IRBuffer(int fd, size_t size = DEFAULT_SIZE);
+		~IRBuffer();
+		bool ok() const { return !failed; }
+};
+
+#endif
@@ -0,0 +1,48 @@
+// -*-Mode: C++;-*-
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef _PHASE_TIMER_H_
+#define _PHASE_TIMER_H_
+
+//////////////////////////////////////////////////////////////////////
+//
+//  phase-timer.h
+//
+//  Where the time goes, for -ftime-report and -ftime-trace=file (see
+//  handle_flags.cc).  A PhaseTimer measures one phase of the program,
+//  from its construction to end() or its destruction: the wall and CPU
+//  time, the number of allocations made through the global operator new
+//  and of strings interned in the string tables (both on any thread) and
+//  the peak resident set size at its end.  Phases may nest, and are only
+//  started and ended on the main thread.
+//
+//  Recording starts with a phase "total" that covers the whole run.
+//  When the program exits, however it does, any phases still open are
+//  ended and the phases are printed as a table on cerr (-ftime-report)
+//  and/or written to file in Chrome's trace-event JSON format, which
+//  chrome://tracing and Perfetto load (-ftime-trace=file).  Without
+//  either flag a PhaseTimer does nothing.
+//
+//////////////////////////////////////////////////////////////////////
+
+class PhaseTimer {
+private:
+  int phase;            // the index of the phase, or -1 if not recording
+
+public:
+  explicit PhaseTimer(const char *name);
+  ~PhaseTimer() { end(); }
+  void end();
+};
+
+//
+// Start recording; report and trace_file say what to write at exit.
+// Called by handle_flags.
+//
+void phase_timer_enable(bool report, const char *trace_file);
+
+#endif
@@ -12,6 +12,9 @@
 #include <assert.h>
 #include <string.h>
 #include "list.h"    // list template
+#include "arena.h"   // storage for entries and their strings
+#include <mutex>
+#include <atomic>
 #include "cool-io.h"
 #include "stringtab.handcode.h"
 
@@ -32,11 +35,15 @@ protected:
   char *str;     // the string
   int  len;      // the length of the string (without trailing \0)
   int index;     // a unique index for each string
+  unsigned hash; // hash_string(str,len), cached for the table's index
 public:
-  Entry(char *s, int l, int i);
+  Entry(const char *s, int l, int i);
+
+  // hash of the first len characters of s; equal strings hash equally
+  static unsigned hash_string(const char *s, int len);
 
   // is string argument equal to the str of this Entry?
-  int equal_string(char *s, int len) const;  
+  int equal_string(const char *s, int len) const;  
                          
   // is the integer argument equal to the index of this Entry?
   bool equal_index(int ind) const           { return ind == index; }
@@ -46,6 +53,11 @@ public:
   // Return the str and len components of the Entry.
   char *get_string() const;
   int get_len() const;
+  unsigned get_hash() const                 { return hash; }
+
+  // for StringTable::renumber
+  int get_index() const                     { return index; }
+  void set_index(int i)                     { index = i; }
 };
 
 //
@@ -63,7 +75,7 @@ public:
 //
 class StringEntry : public Entry {
 public:
-  StringEntry(char *s, int l, int i);
+  StringEntry(const char *s, int l, int i);
 
 #ifdef StringEntry_EXTRAS
    StringEntry_EXTRAS
@@ -72,12 +84,12 @@ public:
 
 class IdEntry : public Entry {
 public:
-  IdEntry(char *s, int l, int i);
+  IdEntry(const char *s, int l, int i);
 };
 
 class IntEntry: public Entry {
 public:
-  IntEntry(char *s, int l, int i);
+  IntEntry(const char *s, int l, int i);
 
 #ifdef IntEntry_EXTRAS
    IntEntry_EXTRAS
@@ -100,29 +112,74 @@ class StringTable
 protected:
    List<Elem> *tbl;   // a string table is a list
    int index;         // the current index
+
+   // Hash index over tbl, split into STRIPES open-addressing tables of
+   // entries keyed by their cached hash.  The top bits of a hash pick
+   // the stripe, and each stripe has its own lock, so threads interning
+   // different strings seldom wait for each other.
+   enum { STRIPE_BITS = 4, STRIPES = 1 << STRIPE_BITS };
+   struct Stripe {
+     std::mutex lock;
+     Elem **slots;    // capacity slots, NULL when empty
+     int capacity;    // a power of two, at least twice count
+     int count;
+     constexpr Stripe() : slots((Elem **) NULL), capacity(0), count(0) { }
+   };
+   Stripe stripes[STRIPES];
+
+   // An array of entries ordered by index
+   Elem **entries;    // entries[i] has index i
+   int entries_size;  // allocated length of entries
+
+   // While renumbering, the new index of each entry (-1 if not yet given)
+   int *renumbered;
+   int renumber_first, renumber_next;
+
+   Stripe &stripe(unsigned h) { return stripes[h >> (32 - STRIPE_BITS)]; }
+   Elem *find(Stripe &st, const char *s, int len, unsigned h);
+   void insert(Stripe &st, Elem *e);
+   void grow(Stripe &st);
+   void append(Elem *e);
 public:
-   StringTable(): tbl((List<Elem> *) NULL), index(0) { }   // an empty table
+   constexpr StringTable(): tbl((List<Elem> *) NULL), index(0),
+                  entries((Elem **) NULL), entries_size(0),
+                  renumbered((int *) NULL), renumber_first(0),
+                  renumber_next(0) { } // an empty table
    // The following methods each add a string to the string table.  
    // Only one copy of each string is maintained.  
    // Returns a pointer to the string table entry with the string.
 
    // add the prefix of s of length maxchars
-   Elem *add_string(char *s, int maxchars);
+   Elem *add_string(const char *s, int maxchars);
+
+   // add exactly the len characters at s, which need not be null terminated
+   Elem *add_chars(const char *s, int len);
 
    // add the (null terminated) string s
-   Elem *add_string(char *s);
+   Elem *add_string(const char *s);
 
    // add the string representation of an integer
    Elem *add_int(int i);
 
+   // Entries added by several threads at once are numbered in whatever
+   // order the threads happened to run.  To number them as a single
+   // thread would have, call renumber(e) for each of them in the
+   // sequential order, between renumber_begin(first) and renumber_end().
+   // Entries with indices below first keep them; any others not passed
+   // to renumber follow, in their old order.
+   void renumber_begin(int first);
+   void renumber(Elem *e);
+   void renumber_end();
+
 
    // An iterator.
    int first();       // first index
    int more(int i);   // are there more indices?
    int next(int i);   // next index
+   int count() const  { return index; }   // number of entries
 
    Elem *lookup(int index);      // lookup an element using its index
-   Elem *lookup_string(char *s); // lookup an element using its string
+   Elem *lookup_string(const char *s); // lookup an element using its string
 
    void print();  // print the entire table; for debugging
 
@@ -146,6 +203,20 @@ public:
 #endif
 };
 
+// Entries, their strings and the table's list nodes are allocated here.
+extern Arena stringtab_arena;
+
+// add_* may be called by several threads at once (the parallel lexer's,
+// say).  Looking up an existing string locks only its table's stripe;
+// creating an entry also holds stringtab_lock, which guards the arena
+// and every table's index, entries and tbl.  Nothing else in a table
+// may run while other threads are adding to it.
+extern std::mutex stringtab_lock;
+
+// The number of strings interned (add_* calls, found or new) in every
+// table, which -ftime-report gives for each phase.
+extern std::atomic<long> stringtab_interns;
+
 extern IdTable idtable;
 extern IntTable inttable;
 extern StrTable stringtable;
@@ -14,6 +14,11 @@
 #ifndef _SYMTAB_H_
 #define _SYMTAB_H_
 
+#include <stddef.h>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <unordered_map>
 #include "list.h"
 
 // added to prevent clash with llvm::SymbolTable
@@ -36,57 +41,135 @@ public:
   DAT *get_info() const { return info; }
 };
 
+//
+// SymbolMap<SYM,DAT> is an immutable map from symbols of type `SYM' to
+//    data of type `DAT *', for tables that many others extend, as a
+//    class's features extend its parent's.  `add' gives a new map and
+//    leaves the old one as it was; the two share all but the O(log n)
+//    nodes on the path to the new binding.  The map is a trie on the
+//    bits of each symbol's hash, so it needs no rebalancing.  Maps are
+//    passed by value; their nodes are never freed.
+//
+//    `add(s,i)' returns this map with `s' bound to `i'.
+//
+//    `lookup(s)' returns the data `s' is bound to, or NULL.
+//
+
+template <class SYM, class DAT>
+class SymbolMap
+{
+   struct Node {
+       SYM id;
+       DAT *info;
+       const Node *child[2];
+   };
+   const Node *root;
+
+   SymbolMap(const Node *r) : root(r) { }
+
+   // std::hash of a pointer is the pointer, whose low bits are all zero
+   static size_t hash(SYM s)
+   {
+       size_t h = std::hash<SYM>()(s);
+       h ^= h >> 29;
+       h *= (size_t) 0xbf58476d1ce4e5b9ULL;
+       return h ^ (h >> 32);
+   }
+
+   static const Node *insert(const Node *n, SYM s, DAT *i, size_t h)
+   {
+       Node *copy = new Node;
+       if (n == NULL) {
+	   copy->id = s;
+	   copy->info = i;
+	   copy->child[0] = copy->child[1] = NULL;
+       } else {
+	   *copy = *n;
+	   if (n->id == s)
+	       copy->info = i;
+	   else
+	       copy->child[h & 1] = insert(n->child[h & 1], s, i, h >> 1);
+       }
+       return copy;
+   }
+public:
+   SymbolMap() : root(NULL) { }
+
+   SymbolMap add(SYM s, DAT *i) const
+   {
+       return SymbolMap(insert(root, s, i, hash(s)));
+   }
+
+   DAT *lookup(SYM s) const
+   {
+       size_t h = hash(s);
+       for (const Node *n = root; n != NULL; n = n->child[h & 1], h >>= 1)
+	   if (n->id == s)
+	       return n->info;
+       return NULL;
+   }
+};
+
 //
 // SymbolTable<SYM,DAT> describes a symbol table mapping symbols of
-//    type `SYM' to data of type `DAT *'.  It is implemented as a
-//    list of lists of `SymtabEntry<SYM,DAT> *'.  The inner list is
-//    a scope, a mapping from symbols to data, and the outer list is
-//    a list of scopes. 
-//
-//    `tbl' points to the current top scope.
-//
-//    `enterscope' makes the table point to a new scope whose parent
-//       is the scope it pointed to previously.
-//
-//    `exitscope' makes the table point to the parent scope of the
-//        current scope.  Note that the old child scope is not
-//        deallocated.  One may save the state of a symbol table
-//        at a given point by copying it with `operator ='
-//
-//    `addid(s,i)' adds a symbol table entry to the current scope of
-//        the symbol table mapping symbol `s' to data `d'.  The old
-//        top scope isn't modified; a new scope is created whose
-//        entry list is the new entry followed by the old entry list,
-//        and whose tail is the old top scope's parent.  The table
-//        is made to point to this new scope.
-//
-//    `lookup(s)' looks for the symbol `s', starting at the top scope
-//        and proceeding down the list of scopes until either an
-//        entry is found whose `get_id()' equals `s', or the end of
-//        the root scope is reached.  It returns the data item
-//        associated with the entry, or NULL if no such entry exists.
-//
-//    
-//    `probe(s)' checks the top scope for an entry whose `get_id()'
-//        equals `s', and returns the entry's `get_info()' if
-//        found, and NULL otherwise.
+//    type `SYM' to data of type `DAT *'.  Every binding ever added and
+//    not yet removed is kept, in the order added, in the log `bindings';
+//    `scopes' holds the size the log had when each open scope was
+//    entered, so the bindings of the top scope are the tail of the log.
+//    `current' maps each symbol to the position in the log of its
+//    innermost binding, and each binding records the position of the
+//    binding it shadows (-1 if none), so the bindings of a symbol form
+//    a stack threaded through the log.  A table may be built over a
+//    SymbolMap, its `base', which holds bindings outside of every scope:
+//    they are found by `lookup' but never by `probe', and stay.
+//
+//    `enterscope' pushes the current size of the log onto `scopes'.
+//
+//    `exitscope' pops the top scope, removing its bindings from the end
+//        of the log and pointing `current' back at the bindings they
+//        shadowed.  Unlike the list-of-lists table this replaces, the
+//        old scope is gone afterwards; copy the table (by value) to keep
+//        a snapshot.
+//
+//    `addid(s,i)' appends a binding of `s' to `i' to the log and makes
+//        it the innermost binding of `s'.
+//
+//    `lookup(s)' returns the data of the innermost binding of `s', or
+//        NULL if `s' is not bound in any scope.
+//
+//    `probe(s)' returns the data of the innermost binding of `s' if
+//        that binding belongs to the top scope, and NULL otherwise.
+//
+//    `flatten()' returns the base with every binding of every scope
+//        added in order: a map that looks up each symbol as `lookup'
+//        would now.
 //
 //    `dump()' prints the symbols in the symbol table.
 //
+//    All of these except `flatten' and `dump' take constant (amortized)
+//    time, apart from a `lookup' that falls through to the base, which
+//    takes O(log n).
+//
 
 template <class SYM, class DAT>
 class SymbolTable
 {
    typedef SymtabEntry<SYM,DAT> ScopeEntry;
-   typedef List<ScopeEntry> Scope;
-   typedef List<Scope> ScopeList;
+   struct Binding {
+       ScopeEntry entry;
+       int shadowed;       // log position of the previous binding, or -1
+       Binding(SYM s, DAT *i, int sh) : entry(s,i), shadowed(sh) { }
+   };
 private:
-   ScopeList  *tbl;
+   std::deque<Binding> bindings;              // the log, oldest first
+   std::vector<int> scopes;                   // log size at each enterscope
+   std::unordered_map<SYM,int> current;       // innermost binding of each SYM
+   SymbolMap<SYM,DAT> base;                   // bindings below every scope
 public:
-   SymbolTable(): tbl(NULL) { }     // create a new symbol table
+   SymbolTable() { }     // create a new symbol table
 
-   // Create pointer to current symbol table.
-   //SymbolTable &operator =(const SymbolTable &s) { tbl = s.tbl; return *this; }
+   // create a new symbol table over the bindings of base
+   SymbolTable(const SymbolMap<SYM,DAT> &b) : base(b) { }
 
    void fatal_error(char * msg)
    {
@@ -94,46 +177,47 @@ public:
      exit(1);
    } 
 
-   // Enter a new scope.  A symbol table is organized as a list of
-   // lists.  The head of the list is the innermost scope, the tail
-   // holds the outer scopes.  A scope must be entered before anything
+   // Enter a new scope.  A scope must be entered before anything
    // can be added to the table.
 
    void enterscope()
    {
-       // The cast of NULL is required for template instantiation to work
-       // correctly.
-       tbl = new ScopeList((Scope *) NULL, tbl);
+       scopes.push_back(bindings.size());
    }
 
    // Pop the first scope off of the symbol table.
    void exitscope()
    {
        // It is an error to exit a scope that doesn't exist.
-       if (tbl == NULL) {
+       if (scopes.empty()) {
 	   fatal_error((char *)"exitscope: Can't remove scope from an empty symbol table.");
        }
-       ScopeList *exited = tbl;
-       tbl = tbl->tl();
-
-       for (Scope *i = exited->hd(), *next; i != NULL; i = next) {
-           next = i->tl();
-           delete i->hd();
-           delete i;
+       int mark = scopes.back();
+       scopes.pop_back();
+       while ((int) bindings.size() > mark) {
+	   Binding &b = bindings.back();
+	   if (b.shadowed < 0)
+	       current.erase(b.entry.get_id());
+	   else
+	       current[b.entry.get_id()] = b.shadowed;
+	   bindings.pop_back();
        }
-       delete exited;
    }
 
    // Add an item to the symbol table.
    ScopeEntry *addid(SYM s, DAT *i)
    {
        // There must be at least one scope to add a symbol.
-       if (tbl == NULL) fatal_error((char *)"addid: Can't add a symbol without a scope.");
-       ScopeEntry * se = new ScopeEntry(s,i);
-       ScopeList * oldScopeList = tbl;
-       tbl = new ScopeList(new Scope(se, tbl->hd()), tbl->tl());
-       delete oldScopeList;
-       return(se);
+       if (scopes.empty()) fatal_error((char *)"addid: Can't add a symbol without a scope.");
+       std::pair<typename std::unordered_map<SYM,int>::iterator, bool> ins =
+	   current.insert(std::make_pair(s, (int) bindings.size()));
+       int shadowed = -1;
+       if (!ins.second) {
+	   shadowed = ins.first->second;
+	   ins.first->second = bindings.size();
+       }
+       bindings.push_back(Binding(s, i, shadowed));
+       return &bindings.back().entry;
    }
    
    // Lookup an item through all scopes of the symbol table.  If found
@@ -142,39 +226,43 @@ public:
 
    DAT * lookup(SYM s)
    {
-       for(ScopeList *i = tbl; i != NULL; i=i->tl()) {
-	   for( Scope *j = i->hd(); j != NULL; j = j->tl()) {
-	       if (s == j->hd()->get_id()) {
-		   return (j->hd()->get_info());
-	       }
-	   }
-       }
-       return NULL;
+       typename std::unordered_map<SYM,int>::iterator i = current.find(s);
+       if (i == current.end())
+	   return base.lookup(s);
+       return bindings[i->second].entry.get_info();
    }
 
    // probe the symbol table.  Check the top scope (only) for the item
    // 's'.  If found, return the information field.  If not return NULL.
    DAT *probe(SYM s)
    {
-       if (tbl == NULL) {
+       if (scopes.empty()) {
 	   fatal_error((char *)"probe: No scope in symbol table.");
        }
-       for(Scope *i = tbl->hd(); i != NULL; i = i->tl()) {
-	   if (s == i->hd()->get_id()) {
-	       return(i->hd()->get_info());
-	   }
-       }
-       return(NULL);
+       typename std::unordered_map<SYM,int>::iterator i = current.find(s);
+       if (i == current.end() || i->second < scopes.back())
+	   return NULL;
+       return bindings[i->second].entry.get_info();
+   }
+
+   SymbolMap<SYM,DAT> flatten() const
+   {
+       SymbolMap<SYM,DAT> map = base;
+       for (size_t j = 0; j < bindings.size(); j++)
+	   map = map.add(bindings[j].entry.get_id(), bindings[j].entry.get_info());
+       return map;
    }
 
    // Prints out the contents of the symbol table  
    void dump()
    {
-      for(ScopeList *i = tbl; i != NULL; i = i->tl()) {
+      int end = bindings.size();
+      for (int k = scopes.size() - 1; k >= 0; k--) {
          cerr << "\nScope: \n";
-         for(Scope *j = i->hd(); j != NULL; j = j->tl()) {
-            cerr << "  " << j->hd()->get_id() << endl;
+         for (int j = end - 1; j >= scopes[k]; j--) {
+            cerr << "  " << bindings[j].entry.get_id() << endl;
          }
+         end = scopes[k];
       }
    }
  
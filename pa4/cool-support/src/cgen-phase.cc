@@ -1,9 +1,13 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <fcntl.h>
 #include "cool-io.h"  //includes iostream
+#include "ir_buffer.h"
 #include "cool-tree.h"
+#include "ast-binary.h"
 #include "cgen_gc.h"
+#include "phase-timer.h"
 
 extern int optind;            // for option processing
 extern char *out_filename;    // name of output assembly
@@ -43,17 +47,37 @@ int main(int argc, char *argv[]) {
   // Don't touch the output file until we know that earlier phases of the
   // compiler have succeeded.
   //
-  ast_yyparse();
+  // The AST comes either as text or, from semant -b, in binary form.
+  //
+  PhaseTimer read_phase("AST read");
+  if (ast_binary_input(ast_file))
+      ast_root = ast_binary_read(ast_file);
+  else
+      ast_yyparse();
+  read_phase.end();
 
+  //
+  // Code is emitted through one large buffer that is written out in big
+  // chunks, rather than through ofstream or cout.
+  //
+  int fd = 1;
   if (out_filename) {
-      ofstream s(out_filename);
-      if (!s) {
+      fd = open(out_filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0) {
 	  cerr << "Cannot open output file " << out_filename << endl;
 	  exit(1);
       }
-      ast_root->cgen(s);
-  } else {
-      ast_root->cgen(cout);
   }
+  IRBuffer buf(fd);
+  ostream s(&buf);
+  PhaseTimer cgen_phase("cgen");
+  ast_root->cgen(s);
+  s.flush();
+  cgen_phase.end();
+  if (!buf.ok()) {
+      cerr << "Error writing output" << endl;
+      exit(1);
+  }
+  if (out_filename) close(fd);
 }
 
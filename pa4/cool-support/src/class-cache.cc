@@ -0,0 +1,115 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "class-cache.h"
+
+#define CACHE_MAGIC "COOLCACHE1"
+#define CACHE_MAGIC_LEN 10
+
+//
+// The first hash is 64-bit FNV-1a; the second multiplies by a different
+// odd constant and folds the high bits back in, so that a pair of inputs
+// that collide in one are not likely to collide in the other.
+//
+CacheKey::CacheKey(const char *kind)
+  : h1(0xcbf29ce484222325ULL), h2(0x9e3779b97f4a7c15ULL)
+{
+  add(kind);
+}
+
+void CacheKey::bytes(const char *s, size_t len)
+{
+  for (size_t i = 0; i < len; i++) {
+    unsigned char c = s[i];
+    h1 = (h1 ^ c) * 0x100000001b3ULL;
+    h2 = (h2 + c) * 0xff51afd7ed558ccdULL;
+    h2 ^= h2 >> 29;
+  }
+}
+
+void CacheKey::add(const char *s, size_t len)
+{
+  char n[8];
+  for (int i = 0; i < 8; i++)
+    n[i] = (char) ((uint64_t) len >> (8 * i));
+  bytes(n, 8);
+  bytes(s, len);
+}
+
+void CacheKey::add(const char *s)
+{
+  add(s, strlen(s));
+}
+
+ClassCache::ClassCache(const char *d) : dir(d), hits(0), misses(0)
+{
+  mkdir(d, 0777);
+}
+
+std::string ClassCache::path(const CacheKey &key)
+{
+  char name[20];
+  snprintf(name, sizeof name, "/%016llx", (unsigned long long) key.name());
+  return dir + name;
+}
+
+static void put_check(char *buf, uint64_t check)
+{
+  for (int i = 0; i < 8; i++)
+    buf[i] = (char) (check >> (8 * i));
+}
+
+bool ClassCache::lookup(const CacheKey &key, std::string &value)
+{
+  FILE *f = fopen(path(key).c_str(), "rb");
+  if (f != NULL) {
+    char header[CACHE_MAGIC_LEN + 8], expected[CACHE_MAGIC_LEN + 8];
+    memcpy(expected, CACHE_MAGIC, CACHE_MAGIC_LEN);
+    put_check(expected + CACHE_MAGIC_LEN, key.check());
+    if (fread(header, 1, sizeof header, f) == sizeof header &&
+        memcmp(header, expected, sizeof header) == 0) {
+      value.clear();
+      char buf[1 << 16];
+      size_t n;
+      while ((n = fread(buf, 1, sizeof buf, f)) > 0)
+        value.append(buf, n);
+      bool ok = !ferror(f);
+      fclose(f);
+      if (ok) {
+        hits++;
+        return true;
+      }
+    } else
+      fclose(f);
+  }
+  misses++;
+  return false;
+}
+
+void ClassCache::store(const CacheKey &key, const std::string &value)
+{
+  std::string final_path = path(key);
+  char suffix[32];
+  snprintf(suffix, sizeof suffix, ".tmp%ld", (long) getpid());
+  std::string tmp_path = final_path + suffix;
+
+  FILE *f = fopen(tmp_path.c_str(), "wb");
+  if (f == NULL)
+    return;
+  char header[CACHE_MAGIC_LEN + 8];
+  memcpy(header, CACHE_MAGIC, CACHE_MAGIC_LEN);
+  put_check(header + CACHE_MAGIC_LEN, key.check());
+  bool ok = fwrite(header, 1, sizeof header, f) == sizeof header &&
+            fwrite(value.data(), 1, value.size(), f) == value.size();
+  if (fclose(f) != 0)
+    ok = false;
+  if (!ok || rename(tmp_path.c_str(), final_path.c_str()) != 0)
+    unlink(tmp_path.c_str());
+}
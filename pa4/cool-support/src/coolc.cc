@@ -0,0 +1,180 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  coolc.cc
+//
+//  The whole compiler in one process: the hand-written scanner of pa1,
+//  the parser of pa2, semant of pa3 and cgen.  The tokens, the Program
+//  and the string tables pass from phase to phase in memory, where
+//  lexer | parser | semant | cgen-2 writes each of them out as text and
+//  reads it back in, interning every symbol again.  The input files are
+//  scanned and parsed, and the classes type checked, on -j threads, as
+//  by the lexer, parser and semant.  Even without -j each file is parsed
+//  on its own, so errors are recovered from per file, as with parser -j
+//  (see parse-context.h).  coolc-check compares coolc with the phases.
+//
+//  The code goes to stdout, or to the file named by -o.  The forms the
+//  separate phases would have passed on can still be written, each to a
+//  file named after the output (or else the first input) file:
+//
+//    -fdump-tokens     base.tokens      the lexer's output
+//    -fdump-ast        base.parsed.ast  the parser's output
+//    -fdump-typed-ast  base.ast         semant's output (binary with -b)
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "cool-io.h"
+#include "cool-tree.h"
+#include "cool-parse.h"
+#include "parse-context.h"
+#include "ir_buffer.h"
+#include "ast-binary.h"
+#include "utilities.h"
+#include "phase-timer.h"
+
+extern int optind;            // for option processing
+extern char *out_filename;    // name of output file (-o)
+extern int parallel_jobs;     // scan and parse on this many threads (-j)
+extern int binary_ast;        // -b: dump the typed AST in binary form
+extern int dump_tokens;       // -fdump-tokens
+extern int dump_ast;          // -fdump-ast
+extern int dump_typed_ast;    // -fdump-typed-ast
+extern Program ast_root;      // the result of the parse
+extern int omerrs;            // a count of lex and parse errors
+
+int curr_lineno;
+char *curr_filename = (char *) "<stdin>";
+
+//
+// The parser reads the token stream through cool_yylex when it is not
+// given the tokens of a file; here it always is.  yy_flex_debug (-l) is
+// for the flex scanners, and none is linked.
+//
+int cool_yylex() { return 0; }
+int yy_flex_debug;
+
+void handle_flags(int argc, char *argv[]);
+
+// defined in utilities.cc
+extern void dump_cool_token(ostream& out, int lineno,
+                            int token, YYSTYPE yylval);
+
+// The name of the dump file with the given suffix.
+static std::string dump_name(const char *base, const char *suffix)
+{
+  std::string name = base;
+  size_t slash = name.rfind('/');
+  size_t dot = name.rfind('.');
+  if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+    name.erase(dot);
+  return name + suffix;
+}
+
+static void open_dump(std::ofstream &out, const std::string &name)
+{
+  out.open(name.c_str());
+  if (!out) {
+    cerr << "Cannot open dump file " << name << endl;
+    exit(1);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  handle_flags(argc, argv);
+  int nfiles = argc - optind;
+  char **files = argv + optind;
+  if (nfiles == 0) {
+    cerr << "usage: " << argv[0] << " [options] file.cl ..." << endl;
+    exit(1);
+  }
+  int threads = parallel_jobs > 0 ? parallel_jobs : 1;
+  const char *base = out_filename ? out_filename : files[0];
+
+  PhaseTimer lex_phase("lexing");
+  std::vector<TokenFile> tokens(nfiles);
+  std::vector<std::vector<CoolToken> > scanned(nfiles);
+  int opened = dfa_lex_files(nfiles, files, threads, &scanned[0]);
+  if (opened < nfiles) {
+    cerr << "Could not open input file " << files[opened] << endl;
+    exit(1);
+  }
+  for (int i = 0; i < nfiles; i++) {
+    tokens[i].filename = files[i];
+    tokens[i].tokens.swap(scanned[i]);
+  }
+  lex_phase.end();
+  if (dump_tokens) {
+    std::ofstream out;
+    open_dump(out, dump_name(base, ".tokens"));
+    for (int i = 0; i < nfiles; i++) {
+      out << "#name \"" << files[i] << "\"" << endl;
+      for (size_t j = 0; j < tokens[i].tokens.size(); j++)
+        dump_cool_token(out, tokens[i].tokens[j].lineno,
+                        tokens[i].tokens[j].token, tokens[i].tokens[j].value);
+    }
+  }
+
+  PhaseTimer parse_phase("parsing");
+  ast_root = parse_files(tokens, threads, &omerrs);
+  parse_phase.end();
+  if (omerrs != 0) {
+    cerr << "Compilation halted due to lex and parse errors\n";
+    exit(1);
+  }
+  if (dump_ast) {
+    std::ofstream out;
+    open_dump(out, dump_name(base, ".parsed.ast"));
+    ast_root->dump_with_types(out, 0);
+  }
+
+  PhaseTimer semant_phase("semant");
+  ast_root->semant();             // exits if there are errors
+  semant_phase.end();
+  if (dump_typed_ast) {
+    std::ofstream out;
+    open_dump(out, dump_name(base, ".ast"));
+    if (binary_ast) {
+      AstWriter writer;
+      ast_root->dump_binary(writer);
+      writer.finish(out);
+    } else
+      ast_root->dump_with_types(out, 0);
+  }
+
+  //
+  // As in cgen-phase.cc, the code goes out through one large buffer, and
+  // the output file is not touched until the earlier phases succeed.
+  //
+  int fd = 1;
+  if (out_filename) {
+    fd = open(out_filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+      cerr << "Cannot open output file " << out_filename << endl;
+      exit(1);
+    }
+  }
+  IRBuffer buf(fd);
+  ostream s(&buf);
+  PhaseTimer cgen_phase("cgen");
+  ast_root->cgen(s);
+  s.flush();
+  cgen_phase.end();
+  if (!buf.ok()) {
+    cerr << "Error writing output" << endl;
+    exit(1);
+  }
+  if (out_filename) close(fd);
+  return 0;
+}
@@ -0,0 +1,89 @@
+/* IRBuffer: a large reusable output buffer drained with one write(2)
+ * per flush.  See ir_buffer.h.
+ */
+#include "ir_buffer.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+IRBuffer::IRBuffer(int f, size_t s) : fd(f), buf(new char[s]), size(s), written(0), failed(false)
+{
+	setp(buf, buf + size);
+}
+
+IRBuffer::~IRBuffer()
+{
+	drain();
+	delete [] buf;
+}
+
+/* Write out everything in the buffer and make it empty again. */
+bool IRBuffer::drain()
+{
+	const char *p = pbase();
+	size_t left = pptr() - pbase();
+	while (left > 0 && !failed) {
+		ssize_t n = write(fd, p, left);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			failed = true;
+		else {
+			p += n;
+			left -= n;
+			written += n;
+		}
+	}
+	setp(buf, buf + size);
+	return !failed;
+}
+
+int IRBuffer::overflow(int c)
+{
+	if (!drain())
+		return traits_type::eof();
+	if (c != traits_type::eof()) {
+		*pptr() = c;
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+std::streamsize IRBuffer::xsputn(const char *s, std::streamsize n)
+{
+	/* the common case: a name or a piece of an instruction that fits */
+	if (n <= epptr() - pptr()) {
+		memcpy(pptr(), s, n);
+		pbump((int) n);
+		return n;
+	}
+
+	std::streamsize done = 0;
+	while (done < n) {
+		std::streamsize room = epptr() - pptr();
+		if (room == 0) {
+			if (!drain())
+				break;
+			continue;
+		}
+		std::streamsize chunk = n - done < room ? n - done : room;
+		memcpy(pptr(), s + done, chunk);
+		/* pbump takes an int; chunk is at most the buffer size */
+		pbump((int) chunk);
+		done += chunk;
+	}
+	return done;
+}
+
+int IRBuffer::sync()
+{
+	return drain() ? 0 : -1;
+}
+
+IRBuffer::pos_type IRBuffer::seekoff(off_type off, std::ios_base::seekdir dir,
+				     std::ios_base::openmode which)
+{
+	if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out))
+		return pos_type(off_type(-1));
+	return pos_type(written + (pptr() - pbase()));
+}
@@ -0,0 +1,181 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <atomic>
+#include <new>
+#include <vector>
+#include "cool-io.h"
+#include "stringtab.h"
+#include "phase-timer.h"
+
+//
+// Every allocation through the global operator new is counted, whether
+// or not phases are being recorded; an uncontended relaxed increment
+// costs next to nothing beside the malloc.
+//
+static std::atomic<long> allocations(0);
+
+void *operator new(size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  for (;;) {
+    void *p = malloc(size != 0 ? size : 1);
+    if (p != NULL)
+      return p;
+    std::new_handler handler = std::get_new_handler();
+    if (handler == NULL)
+      throw std::bad_alloc();
+    handler();
+  }
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+struct Phase {
+  const char *name;
+  int depth;
+  bool open;
+  double wall_start, wall;      // seconds
+  double cpu_start, cpu;
+  long allocs_start, allocs;
+  long interns_start, interns;  // strings interned (see stringtab.h)
+  long peak_rss;                // KB
+};
+
+static bool recording = false;
+static bool report;
+static const char *trace_file;
+static std::vector<Phase> phases;
+static int depth;               // phases open now
+
+static double clock_seconds(clockid_t clock)
+{
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static long peak_rss()
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss;
+}
+
+PhaseTimer::PhaseTimer(const char *name) : phase(-1)
+{
+  if (!recording)
+    return;
+  Phase p;
+  p.name = name;
+  p.depth = depth++;
+  p.open = true;
+  p.wall_start = clock_seconds(CLOCK_MONOTONIC);
+  p.cpu_start = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+  p.allocs_start = allocations.load(std::memory_order_relaxed);
+  p.interns_start = stringtab_interns.load(std::memory_order_relaxed);
+  p.wall = p.cpu = 0;
+  p.allocs = p.interns = p.peak_rss = 0;
+  phase = phases.size();
+  phases.push_back(p);
+}
+
+static void end_phase(Phase &p)
+{
+  p.wall = clock_seconds(CLOCK_MONOTONIC) - p.wall_start;
+  p.cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - p.cpu_start;
+  p.allocs = allocations.load(std::memory_order_relaxed) - p.allocs_start;
+  p.interns = stringtab_interns.load(std::memory_order_relaxed) - p.interns_start;
+  p.peak_rss = peak_rss();
+  p.open = false;
+  depth--;
+}
+
+void PhaseTimer::end()
+{
+  if (phase >= 0 && phases[phase].open)
+    end_phase(phases[phase]);
+  phase = -1;
+}
+
+static void print_report()
+{
+  cerr << "\n===== Time report =====\n";
+  char line[160];
+  snprintf(line, sizeof line, "%-28s %10s %10s %10s %10s %14s\n",
+           "Phase", "Wall (ms)", "CPU (ms)", "Allocs", "Interns",
+           "Peak RSS (KB)");
+  cerr << line;
+  for (size_t i = 0; i < phases.size(); i++) {
+    const Phase &p = phases[i];
+    snprintf(line, sizeof line, "%*s%-*s %10.2f %10.2f %10ld %10ld %14ld\n",
+             2 * p.depth, "", 28 - 2 * p.depth, p.name,
+             p.wall * 1e3, p.cpu * 1e3, p.allocs, p.interns, p.peak_rss);
+    cerr << line;
+  }
+}
+
+// Phase names are fixed strings without quotes or backslashes.
+static void write_trace()
+{
+  FILE *f = fopen(trace_file, "w");
+  if (f == NULL) {
+    cerr << "Cannot create time trace " << trace_file << endl;
+    return;
+  }
+  double origin = phases.empty() ? 0 : phases[0].wall_start;
+  fprintf(f, "{\"traceEvents\":[");
+  for (size_t i = 0; i < phases.size(); i++) {
+    const Phase &p = phases[i];
+    fprintf(f, "%s\n{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\","
+            "\"ts\":%.1f,\"dur\":%.1f,\"pid\":%ld,\"tid\":0,"
+            "\"args\":{\"cpu_ms\":%.3f,\"allocs\":%ld,\"interns\":%ld,"
+            "\"peak_rss_kb\":%ld}}",
+            i == 0 ? "" : ",", p.name, (p.wall_start - origin) * 1e6,
+            p.wall * 1e6, (long) getpid(), p.cpu * 1e3, p.allocs, p.interns,
+            p.peak_rss);
+  }
+  fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  fclose(f);
+}
+
+static void finish()
+{
+  for (size_t i = phases.size(); i-- > 0; )
+    if (phases[i].open)
+      end_phase(phases[i]);
+  recording = false;
+  if (report)
+    print_report();
+  if (trace_file != NULL)
+    write_trace();
+}
+
+void phase_timer_enable(bool r, const char *t)
+{
+  report = report || r;
+  if (t != NULL)
+    trace_file = t;
+  if (!recording) {
+    recording = true;
+    atexit(finish);
+    new PhaseTimer("total");    // ended by finish
+  }
+}
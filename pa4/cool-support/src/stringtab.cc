@@ -18,13 +18,25 @@ template class StringTable<IdEntry>;
 template class StringTable<StringEntry>;
 template class StringTable<IntEntry>;
 
-Entry::Entry(char *s, int l, int i) : len(l), index(i) {
-  str = new char [len+1];
-  strncpy(str, s, len);
-  str[len] = '\0';
+Entry::Entry(const char *s, int l, int i) : len(l), index(i) {
+  str = stringtab_arena.copy_string(s, len);
+  hash = hash_string(str, len);
 }
 
-int Entry::equal_string(char *string, int length) const
+//
+// 32-bit FNV-1a.  Cheap enough to run on every token the lexer interns.
+//
+unsigned Entry::hash_string(const char *s, int len)
+{
+  unsigned h = 2166136261u;
+  for (int i = 0; i < len; i++) {
+    h ^= (unsigned char) s[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+int Entry::equal_string(const char *string, int length) const
 {
   return (len == length) && (strncmp(str,string,len) == 0);
 }
@@ -70,10 +82,13 @@ void dump_Symbol(ostream& s, int n, Symbol sym)
   s << pad(n) << sym << endl;
 }
 
-StringEntry::StringEntry(char *s, int l, int i) : Entry(s,l,i) { }
-IdEntry::IdEntry(char *s, int l, int i) : Entry(s,l,i) { }
-IntEntry::IntEntry(char *s, int l, int i) : Entry(s,l,i) { }
+StringEntry::StringEntry(const char *s, int l, int i) : Entry(s,l,i) { }
+IdEntry::IdEntry(const char *s, int l, int i) : Entry(s,l,i) { }
+IntEntry::IntEntry(const char *s, int l, int i) : Entry(s,l,i) { }
 
+Arena stringtab_arena;
+std::mutex stringtab_lock;
+std::atomic<long> stringtab_interns(0);
 IdTable idtable;
 IntTable inttable;
 StrTable stringtable;
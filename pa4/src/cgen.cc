@@ -7,11 +7,18 @@
 
 #define EXTERN
 #include "cgen.h"
+#include "ast-binary.h"
+#include "class-cache.h"
+#include "phase-timer.h"
 #include <string>
 #include <sstream>
 
 // 
 extern int cgen_debug;
+extern char *cache_dir;
+
+static ClassCache *class_cache;
+static const char *cgen_cache_kind = "cgen " __DATE__ " " __TIME__;
 
 //////////////////////////////////////////////////////////////////////
 //
@@ -122,7 +129,12 @@ static void initialize_constants(void)
 void program_class::cgen(ostream &os) 
 {
 	initialize_constants();
+	if (cache_dir != NULL)
+		class_cache = new ClassCache(cache_dir);
 	class_table = new CgenClassTable(classes,os);
+	if (cgen_debug && class_cache != NULL)
+		std::cerr << "Class cache: " << class_cache->hit_count() << " hits, "
+			<< class_cache->miss_count() << " misses" << endl;
 }
 
 
@@ -488,15 +500,19 @@ CgenClassTable::CgenClassTable(Classes classes, ostream& s)
 	enterscope();
 
 	// Create an inheritance tree with one CgenNode per class.
+	PhaseTimer setup_phase("setup");
 	install_basic_classes();
 	install_classes(classes);
 	build_inheritance_tree();
 
 	// First pass
 	setup();
+	setup_phase.end();
 
 	// Second pass
+	PhaseTimer code_phase("code_module");
 	code_module();
+	code_phase.end();
 	// Done with code generation: exit scopes
 	exitscope();
 }
@@ -545,7 +561,7 @@ void CgenClassTable::code_module()
 	// This must be after code_module() since that emits constants
 	// needed by the code() method for expressions
 	CgenNode* mainNode = getMainmain(root());
-	mainNode->codeGenMainmain(*ct_stream);
+	code_class_cached(mainNode);
 #endif
 	code_main();
 
@@ -559,11 +575,106 @@ void CgenClassTable::code_module()
 #ifdef PA5
 void CgenClassTable::code_classes(CgenNode *c)
 {
+	code_class_cached(c);
+	List<CgenNode> *children = c->get_children();
+	for (List<CgenNode> *child = children; child; child = child->tl())
+		code_classes(child->hd());
+}
+#endif
 
-	// ADD CODE HERE
 
+//
+// A digest of the string and int constant tables, in index order.  Code
+// names a constant by its index, and the indices depend on every class
+// in the program, so code_class_cached adds this to each key.  It is
+// taken once, when the first class is coded.
+//
+static const std::string &constants_digest()
+{
+	static std::string digest;
+	if (digest.empty()) {
+		CacheKey key("constants");
+		key.add(std::to_string(stringtable.count()));
+		for (int i = stringtable.first(); stringtable.more(i); i = stringtable.next(i)) {
+			StringEntry *e = stringtable.lookup(i);
+			key.add(e->get_string(), e->get_len());
+		}
+		key.add(std::to_string(inttable.count()));
+		for (int i = inttable.first(); inttable.more(i); i = inttable.next(i)) {
+			IntEntry *e = inttable.lookup(i);
+			key.add(e->get_string(), e->get_len());
+		}
+		digest = std::to_string(key.name()) + " " + std::to_string(key.check());
+	}
+	return digest;
 }
+
+//
+// Emit the code for one class, through the class cache when there is one
+// (-C, see class-cache.h).  How a class is laid out and coded depends on
+// the class, its ancestors and its tag, the indices of the constants it
+// uses, and the names of its temporaries on how many came before, so the
+// key is the typed AST of each class, the tag, the digest of the
+// constant tables and the next temporary.  An unchanged class whose
+// ancestors have not changed either, in a program with the same
+// constants, is copied from the cache rather than generated.  In phase 1
+// this is Main, for Main_main.
+//
+// The key says nothing about the other classes a class's code uses: the
+// layout of a class it creates or dispatches to, or the tags in a case.
+// Nothing emitted here refers to them yet; code that does must add them
+// to the key, or such a class must not be cached.
+//
+void CgenClassTable::code_class_cached(CgenNode *nd)
+{
+	if (class_cache == NULL) {
+		emit_class(nd, *ct_stream);
+		return;
+	}
+
+	CacheKey key(cgen_cache_kind);
+	for (CgenNode *c = nd; c != NULL; c = c->get_parentnd()) {
+		AstWriter writer;
+		std::ostringstream ast;
+		c->dump_binary(writer);
+		writer.finish(ast);
+		key.add(ast.str());
+	}
+	key.add(std::to_string(nd->get_tag()));
+	key.add(constants_digest());
+	int first_temporary = ValuePrinter::fresh_count();
+	key.add(std::to_string(first_temporary));
+
+	// An entry is the number of temporaries the code uses, a newline and
+	// the code.
+	std::string entry;
+	size_t newline;
+	if (class_cache->lookup(key, entry) &&
+	    (newline = entry.find('\n')) != std::string::npos) {
+		ValuePrinter::set_fresh_count(first_temporary + atoi(entry.c_str()));
+		ct_stream->write(entry.data() + newline + 1, entry.size() - newline - 1);
+		return;
+	}
+
+	std::ostringstream s;
+	emit_class(nd, s);
+	class_cache->store(key, std::to_string(ValuePrinter::fresh_count() - first_temporary) +
+	                       "\n" + s.str());
+	*ct_stream << s.str();
+}
+
+// Generate the code for one class on s.
+void CgenClassTable::emit_class(CgenNode *nd, ostream &s)
+{
+#ifdef PA5
+	ostream *saved_stream = ct_stream;
+	ct_stream = &s;
+	nd->code_class();
+	ct_stream = saved_stream;
+#else
+	nd->codeGenMainmain(s);
 #endif
+}
 
 
 //
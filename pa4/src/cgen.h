@@ -78,6 +78,8 @@ private:
 	void code_module();
 	void code_constants();
 	void code_main();
+	void code_class_cached(CgenNode *nd);
+	void emit_class(CgenNode *nd, ostream &s);
 
 	// ADD CODE HERE
 
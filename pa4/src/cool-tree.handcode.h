@@ -15,6 +15,30 @@
 using std::string;
 
 class CgenEnvironment;
+class AstWriter;
+
+//
+// coolc (coolc.cc) has semant in the same program as cgen, so there the
+// tree classes have semant's members as well (-DCOOLC).
+//
+#ifdef COOLC
+#include "semant-tree.handcode.h"
+#else
+#define SEMANT_Program_EXTRAS
+#define SEMANT_program_EXTRAS
+#define SEMANT_Class__EXTRAS
+#define SEMANT_class__EXTRAS
+#define SEMANT_Feature_EXTRAS
+#define SEMANT_Feature_SHARED_EXTRAS
+#define SEMANT_method_EXTRAS
+#define SEMANT_attr_EXTRAS
+#define SEMANT_Formal_EXTRAS
+#define SEMANT_formal_EXTRAS
+#define SEMANT_Case_EXTRAS
+#define SEMANT_branch_EXTRAS
+#define SEMANT_Expression_EXTRAS
+#define SEMANT_Expression_SHARED_EXTRAS
+#endif
 
 #define yylineno curr_lineno;
 extern int yylineno;
@@ -56,58 +80,80 @@ typedef Cases_class *Cases;
 
 #define Program_EXTRAS                          \
 virtual void cgen(ostream&) = 0;		\
-virtual void dump_with_types(ostream&, int) = 0; 
+virtual void dump_with_types(ostream&, int) = 0; \
+virtual void dump_binary(AstWriter&) = 0; \
+SEMANT_Program_EXTRAS
 
 #define program_EXTRAS                          \
 void cgen(ostream&);     			\
-void dump_with_types(ostream&, int);            
+void dump_with_types(ostream&, int);            \
+void dump_binary(AstWriter&); \
+SEMANT_program_EXTRAS
 
 #define Class__EXTRAS                   \
 virtual Symbol get_name() = 0;  	\
 virtual Symbol get_parent() = 0;    	\
 virtual Symbol get_filename() = 0;      \
-virtual void dump_with_types(ostream&,int) = 0; 
+virtual void dump_with_types(ostream&,int) = 0; \
+virtual void dump_binary(AstWriter&) = 0; \
+SEMANT_Class__EXTRAS
 
 
 #define class__EXTRAS                                  \
 Symbol get_name()   { return name; }		       \
 Symbol get_parent() { return parent; }     	       \
 Symbol get_filename() { return filename; }             \
-void dump_with_types(ostream&,int);                    
+void dump_with_types(ostream&,int);                    \
+void dump_binary(AstWriter&); \
+SEMANT_class__EXTRAS
 
 
 #define Feature_EXTRAS                     		\
 virtual void dump_with_types(ostream&,int) = 0; 	\
+virtual void dump_binary(AstWriter&) = 0;		\
 virtual void layout_feature(CgenNode *cls) = 0;		\
-virtual void code(CgenEnvironment *env) = 0;
+virtual void code(CgenEnvironment *env) = 0; \
+SEMANT_Feature_EXTRAS
 
 
 #define Feature_SHARED_EXTRAS                           \
 void dump_with_types(ostream&,int);  			\
+void dump_binary(AstWriter&);  				\
 void layout_feature(CgenNode *cls);			\
-void code(CgenEnvironment *env);
+void code(CgenEnvironment *env); \
+SEMANT_Feature_SHARED_EXTRAS
 
 
 #define method_EXTRAS			\
-virtual Symbol get_return_type() { return return_type; }
+virtual Symbol get_return_type() { return return_type; } \
+SEMANT_method_EXTRAS
+
+#define attr_EXTRAS			\
+SEMANT_attr_EXTRAS
 
 #define Formal_EXTRAS                              \
 virtual Symbol get_type_decl() = 0;                /* ## */ \
 virtual Symbol get_name()      = 0;                /* ## */ \
-virtual void dump_with_types(ostream&,int) = 0;
+virtual void dump_with_types(ostream&,int) = 0;    \
+virtual void dump_binary(AstWriter&) = 0; \
+SEMANT_Formal_EXTRAS
 
 
 #define formal_EXTRAS                           \
 Symbol get_type_decl() { return type_decl; }    /* ## */ \
 Symbol get_name()      { return name; }         /* ## */ \
-void dump_with_types(ostream&,int);
+void dump_with_types(ostream&,int);             \
+void dump_binary(AstWriter&); \
+SEMANT_formal_EXTRAS
 
 
 #define Case_EXTRAS                             \
 virtual Symbol get_type_decl() = 0; 		\
 virtual operand code(operand, operand, const op_type,  \
 	CgenEnvironment *) = 0;	\
-virtual void dump_with_types(ostream& ,int) = 0;
+virtual void dump_with_types(ostream& ,int) = 0;	\
+virtual void dump_binary(AstWriter&) = 0; \
+SEMANT_Case_EXTRAS
 
 
 #define branch_EXTRAS                                   	\
@@ -115,7 +161,9 @@ Symbol get_type_decl() { return type_decl; } 			\
 Expression get_expr() { return expr; }		\
 operand code(operand expr_val, operand tag, 	\
 	const op_type join_type, CgenEnvironment *env); 	\
-void dump_with_types(ostream& ,int);
+void dump_with_types(ostream& ,int);				\
+void dump_binary(AstWriter&); \
+SEMANT_branch_EXTRAS
 
 
 #define Expression_EXTRAS                    \
@@ -124,13 +172,17 @@ Symbol get_type() { return type; }           \
 Expression set_type(Symbol s) { type = s; return this; } \
 virtual int no_code() { return 0; }          /* ## */ \
 virtual void dump_with_types(ostream&,int) = 0;  \
+virtual void dump_binary(AstWriter&) = 0;    \
 virtual operand code(CgenEnvironment *)=0;	   \
 void dump_type(ostream&, int);               \
-Expression_class() { type = (Symbol) NULL; }
+Expression_class() { type = (Symbol) NULL; } \
+SEMANT_Expression_EXTRAS
 
 #define Expression_SHARED_EXTRAS           \
 operand code(CgenEnvironment *);	   \
-void dump_with_types(ostream&,int); 
+void dump_with_types(ostream&,int); \
+void dump_binary(AstWriter&); \
+SEMANT_Expression_SHARED_EXTRAS
 
 #define no_expr_EXTRAS        /* ## */ \
 int no_code() { return 1; }   /* ## */
@@ -1,74 +1,145 @@
 #include "operand.h"
+#include <stdio.h>
+#include <deque>
+#include <unordered_map>
 
-op_type::op_type(op_type_id i) : id(i){
+/* The name table.  A deque never moves its elements, so the strings can
+ * be handed out by reference.  It is built on first use because op_types
+ * may be constructed by other static initializers.
+ */
+struct NameTable {
+	std::deque<string> names;
+	std::unordered_map<string, int> index;
+	NameTable() { names.push_back(""); index[""] = 0; }
+};
+
+static NameTable &name_table()
+{
+	static NameTable table;
+	return table;
+}
+
+int intern_name(const string &s)
+{
+	NameTable &t = name_table();
+	std::unordered_map<string, int>::iterator it = t.index.find(s);
+	if (it != t.index.end())
+		return it->second;
+	int i = t.names.size();
+	t.names.push_back(s);
+	t.index[s] = i;
+	return i;
+}
+
+const string &interned_name(int i)
+{
+	return name_table().names[i];
+}
+
+string operand::get_name() const
+{
+	char buf[24];
+	switch (kind) {
+		case TEMPORARY:
+			snprintf(buf, sizeof(buf), "%%vtpm.%d", name);
+			return buf;
+		case INTEGER:
+			snprintf(buf, sizeof(buf), "%d", name);
+			return buf;
+		default:
+			return interned_name(name);
+	}
+}
+
+ostream &operator<<(ostream &o, const operand &op)
+{
+	char buf[24];
+	int len;
+	switch (op.kind) {
+		case operand::TEMPORARY:
+			len = snprintf(buf, sizeof(buf), "%%vtpm.%d", op.name);
+			return o.write(buf, len);
+		case operand::INTEGER:
+			len = snprintf(buf, sizeof(buf), "%d", op.name);
+			return o.write(buf, len);
+		default:
+			return o << interned_name(op.name);
+	}
+}
+
+static const char *builtin_type_name(op_type_id id) {
 	switch (id) {
 		case EMPTY:
-			name = "";
-			break;
+			return "";
 		case VOID:
-			name = "void";
-			break;
+			return "void";
 		case INT1:
-			name = "i1";
-			break;
+			return "i1";
 		case INT8:
-			name = "i8";
-			break;
+			return "i8";
 		case INT32:
-			name = "i32";
-			break;
+			return "i32";
 		case INT1_PTR:
-			name = "i1*";
-			break;
+			return "i1*";
 		case INT8_PTR:
-			name = "i8*";
-			break;
+			return "i8*";
 		case INT32_PTR:
-			name = "i32*";
-			break;
+			return "i32*";
 		case INT1_PPTR:
-			name = "i1**";
-			break;
+			return "i1**";
 		case INT8_PPTR:
-			name = "i8**";
-			break;
+			return "i8**";
 		case INT32_PPTR:
-			name = "i32**";
-			break;
+			return "i32**";
 		case VAR_ARG:
-			name = "...";
-			break;
+			return "...";
 		case OBJ:
 		case OBJ_PTR:
 		case OBJ_PPTR:
-			break;
+			return "";
 		default:
 			assert(0 && "Variable type not implemented");
-			
 	}
+	return "";
+}
+
+/* Builtin types are by far the most common, so their name indices are
+ * looked up once per type id rather than hashed every time.
+ */
+op_type::op_type(op_type_id i) : id(i){
+	static int builtin_names[OBJ_PPTR + 1];
+	static bool builtin_interned[OBJ_PPTR + 1];
+	if (i < EMPTY || i > OBJ_PPTR)
+		assert(0 && "Variable type not implemented");
+	if (!builtin_interned[i]) {
+		builtin_names[i] = intern_name(builtin_type_name(i));
+		builtin_interned[i] = true;
+	}
+	name = builtin_names[i];
 }
 
 op_type::op_type(string n, int ptr_level) {
-	name = "%" + n;
+	string type_name = "%" + n;
 	id = OBJ;
 	// Pointer to an object
 	if (ptr_level == 1) {
-		name += "*";
+		type_name += "*";
 		id = OBJ_PTR;
 	}
 	// Pointer to a pointer to an object;
 	if (ptr_level == 2) {
 		id = OBJ_PPTR;
-		name += "**";
+		type_name += "**";
 	}
 
 	if (ptr_level > 2 || ptr_level < 0)
 		assert(0 && "Invalid pointer level");
+	name = intern_name(type_name);
 }	
 
 /* Get a pointer type of the current type
  */
-op_type op_type::get_ptr_type() {
+op_type op_type::get_ptr_type() const {
 	op_type_id ptr_id;
 	switch (id) {
 		case INT1:
@@ -100,7 +171,7 @@ op_type op_type::get_ptr_type() {
 	}
 	op_type ptr_type;
 	if (ptr_id == OBJ_PTR || ptr_id == OBJ_PPTR) {
-		op_type new_type(string(name.c_str() + 1), 1);
+		op_type new_type(string(get_name().c_str() + 1), 1);
 		new_type.set_id(ptr_id);
 		ptr_type = new_type;
 	}
@@ -113,7 +184,7 @@ op_type op_type::get_ptr_type() {
 
 /* The inverse of get_ptr_type()
  */
-op_type op_type::get_deref_type() {
+op_type op_type::get_deref_type() const {
 	op_type_id deref_id;
 	switch(id) {
 		case INT1_PTR:
@@ -147,7 +218,8 @@ op_type op_type::get_deref_type() {
 	if (deref_id == OBJ || deref_id == OBJ_PTR) {
 		//char *new_name = name.c_str() + 1;
 		//new_name[strlen(new_name) - 1] = '\0';
-		string new_name = name.substr(1, name.length() - 2);
+		const string &type_name = get_name();
+		string new_name = type_name.substr(1, type_name.length() - 2);
 		op_type new_type(new_name);
 		new_type.set_id(deref_id);
 		deref_type = new_type;
@@ -164,30 +236,32 @@ op_type op_type::get_deref_type() {
  */
 op_arr_type::op_arr_type(op_type_id i, int s) : op_type(i){
 	int num_width = 1;
-	string type_name = name, size_str = " ";
+	string type_name = get_name(), size_str = " ";
 	size = s;
 	for (int j = s; j > 9; j %= 10)
 		size_str += " ";
 	if (is_ptr())
 		type_name.erase(type_name.length() - 1);
-	name = "[" + itoa(s, size_str) + " x " + type_name + "]";
+	type_name = "[" + itoa(s, size_str) + " x " + type_name + "]";
 	if (is_ptr())
-		name += "*";
+		type_name += "*";
+	name = intern_name(type_name);
 };
 
 /* Function and Function pointer types */
 op_func_type::op_func_type(op_type res_type, vector<op_type> arg_types)
   : op_type(EMPTY), res(res_type), args(arg_types)
 {
-	name = string(res_type.get_name() + " (");
+	string type_name = string(res_type.get_name() + " (");
 	if (arg_types.size() == 0)
-		name.append(") *");
+		type_name.append(") *");
 	else {
 		unsigned i;
 		for (i = 0; i < arg_types.size()-1; i++)
-			name.append(arg_types[i].get_name() + ",");
-		name.append(arg_types[i].get_name() + ") *");
+			type_name.append(arg_types[i].get_name() + ",");
+		type_name.append(arg_types[i].get_name() + ") *");
 	}
+	name = intern_name(type_name);
 }
 
 op_type op_func_type::get_ptr_type() { return op_func_ptr_type(res, args); }
@@ -200,7 +274,7 @@ op_func_ptr_type::op_func_ptr_type(op_type res_type, vector<op_type> arg_types)
   : op_type(EMPTY), res(res_type), args(arg_types)
 {
 	op_func_type func_type(res_type, arg_types);
-	name = string(func_type.get_name() + "*");
+	name = intern_name(func_type.get_name() + "*");
 }
 
 op_type op_func_ptr_type::get_ptr_type() {
@@ -18,6 +18,15 @@ using std::string;
 using std::ostream;
 using std::vector;
 
+/* Names of types and operands are interned: each distinct LLVM name is
+ * stored once in a table and op_type/operand objects hold only its index,
+ * so copying them (which happens for every operand of every instruction)
+ * copies a few integers rather than strings.  Index 0 is the empty name.
+ * References returned by interned_name stay valid for the whole run.
+ */
+int intern_name(const string &s);
+const string &interned_name(int i);
+
 /* All the types needed in PA4 */
 typedef enum {EMPTY, VOID, INT1, INT1_PTR, INT1_PPTR, INT8, INT8_PTR, INT8_PPTR, 
 	      INT32, INT32_PTR, INT32_PPTR, VAR_ARG, 
@@ -26,37 +35,39 @@ typedef enum {EMPTY, VOID, INT1, INT1_PTR, INT1_PPTR, INT8, INT8_PTR, INT8_PPTR,
 class op_type {
 	protected:
 		op_type_id id;
-		/* LLVM string representation of a type */
-		string name;
+		/* LLVM string representation of a type, as an index into the
+		   name table */
+		int name;
 	public:
-		op_type() : id(EMPTY), name(""){}
+		op_type() : id(EMPTY), name(0){}
 		op_type(op_type_id i);
-		op_type(string n) : id(OBJ), name("%" + n) {}
+		op_type(string n) : id(OBJ), name(intern_name("%" + n)) {}
 		op_type(string n, int ptr_level);
-		op_type_id get_id() { return id; }
+		op_type_id get_id() const { return id; }
 		void set_id(op_type_id i) { id = i; }
 		void set_type(op_type t) 
-		  { id = t.get_id(); name = t.get_name(); }
-		string get_name() { return name; }
-		bool is_ptr() 
+		  { id = t.get_id(); name = t.name; }
+		const string &get_name() const { return interned_name(name); }
+		bool is_ptr() const
 		  { return (id == INT1_PTR || id == INT8_PTR || 
 		            id == INT32_PTR || id == OBJ_PTR); }
-		op_type get_ptr_type();
-		op_type get_deref_type();
+		op_type get_ptr_type() const;
+		op_type get_deref_type() const;
 		/* Is the type a double pointer? */
-		bool is_pptr()
+		bool is_pptr() const
 		  { return (id == INT1_PPTR || id == INT8_PPTR ||
 		            id == INT32_PPTR || id == OBJ_PPTR); }
-		bool is_int_object()
-		  { return id == OBJ_PTR && name.compare("%Int*")==0; }
-		bool is_bool_object()
-		  { return id == OBJ_PTR && name.compare("%Bool*")==0; }
-		bool is_string_object()
-		  { return id == OBJ_PTR && name.compare("%String*")==0; }
-		bool is_self_type()
-		  { return id == OBJ && name.compare("%SELF_TYPE")==0; }
-		bool is_same_with(op_type t)
-		  { return name.compare(t.get_name())==0; }
+		bool is_int_object() const
+		  { return id == OBJ_PTR && get_name().compare("%Int*")==0; }
+		bool is_bool_object() const
+		  { return id == OBJ_PTR && get_name().compare("%Bool*")==0; }
+		bool is_string_object() const
+		  { return id == OBJ_PTR && get_name().compare("%String*")==0; }
+		bool is_self_type() const
+		  { return id == OBJ && get_name().compare("%SELF_TYPE")==0; }
+		/* equal names have equal indices */
+		bool is_same_with(const op_type &t) const
+		  { return name == t.name; }
 };
 
 /* Arrays are derived from op_type */
@@ -95,41 +106,57 @@ class op_func_ptr_type : public op_type {
 };
 
 
+/* An operand's name is only turned into text when it is printed (see
+ * operator<< below).  Named operands refer to the name table; temporaries
+ * created by ValuePrinter print as %vtpm.<n> and integer constants as
+ * <n>, so creating either never touches a string.
+ */
 class operand {
 	protected:
+		typedef enum {NAMED, TEMPORARY, INTEGER} name_kind;
 		op_type type;
-		string name;
+		name_kind kind;
+		int name;	/* name table index, temporary number or integer */
+		operand(op_type t, name_kind k, int n) : type(t), kind(k), name(n) {}
 	public:
-		operand() : type(EMPTY), name("") { }
+		operand() : type(EMPTY), kind(NAMED), name(0) { }
 		operand(const operand& other)
-		  : type(other.type), name(other.name) {}
-		operand(op_type t, string n) : type(t), name("%" + n) {}
-		op_type get_type() { return type; }
+		  : type(other.type), kind(other.kind), name(other.name) {}
+		operand(op_type t, string n) : type(t), kind(NAMED), name(intern_name("%" + n)) {}
+		/* The n-th fresh temporary, %vtpm.n */
+		static operand temporary(op_type t, int n) { return operand(t, TEMPORARY, n); }
+		op_type get_type() const { return type; }
 		void set_type(op_type t) { type = t; }
-		string get_typename() { return type.get_name(); }
-		string get_name () { return name; }
-		bool is_empty() { return type.get_id() == EMPTY; }
+		const string &get_typename() const { return type.get_name(); }
+		string get_name () const;
+		bool is_empty() const { return type.get_id() == EMPTY; }
+		friend ostream &operator<<(ostream &o, const operand &op);
 };
 
+/* Print the operand's name, as get_name() would return it */
+ostream &operator<<(ostream &o, const operand &op);
+
 class global_value : public operand {
 	private:
 		operand value;
 	public:
 		global_value(op_type t, string n, operand v) 
-		  { type = t; name = "@" + n; value = v;}
-		global_value(op_type t, string n) { type = t; name = "@" + n;}
+		  { type = t; name = intern_name("@" + n); value = v;}
+		global_value(op_type t, string n) { type = t; name = intern_name("@" + n);}
 		operand get_value() { return value; }
 };
 
+/* The value of a constant is also its name. */
 class const_value : public operand {
 	protected:
-		string value;
 		bool internal;
+		const_value(op_type t, int i, bool intr)
+		  : operand(t, INTEGER, i), internal(intr) { }
 	public:
 		const_value(op_type t, string val, bool intr)
-		  : value(val), internal(intr) { type = t; name = value; }
-		bool is_internal() { return internal; }
-		string get_value() { return value; }
+		  : internal(intr) { type = t; name = intern_name(val); }
+		bool is_internal() const { return internal; }
+		string get_value() const { return get_name(); }
 };
 
 class casted_value : public const_value {
@@ -140,7 +167,7 @@ class casted_value : public const_value {
 		  const_value(t, "bitcast ("+precast_t.get_name()+" "+val+" to "+t.get_name()+")", true),
 		  precast_type(precast_t) { }
 		op_type get_precast_type() { return precast_type; }
-		string get_precasttypename() { return precast_type.get_name(); }
+		const string &get_precasttypename() { return precast_type.get_name(); }
 };
 
 class int_value : public const_value {
@@ -148,9 +175,9 @@ class int_value : public const_value {
 		int i_value;
 	public:
 		int_value(int i)
-		  : const_value(op_type(INT32), itos(i), true), i_value(i) {}
+		  : const_value(op_type(INT32), i, true), i_value(i) {}
 		int_value(int i, bool intr)
-		  : const_value(op_type(INT32), itos(i), intr), i_value(i) {}
+		  : const_value(op_type(INT32), i, intr), i_value(i) {}
 		int get_intvalue() { return i_value; }
 };
 
@@ -159,8 +186,7 @@ class bool_value : public const_value {
 		bool b_value;
 	public:
 		bool_value(bool b, bool intr)
-		  : const_value(op_type(INT1), "", intr), b_value(b)
-		  { if (b) value = "true"; else value = "false"; name = value;}
+		  : const_value(op_type(INT1), b ? "true" : "false", intr), b_value(b) {}
 		int get_boolvalue() { return b_value; }
 };
 
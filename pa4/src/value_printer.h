@@ -17,8 +17,8 @@ typedef enum {EQ, NE, LT, LE, GT, GE} icmp_val;
 
 class ValuePrinter {
 	private:
-		void bin_inst(ostream &o, string inst_name, operand op1, operand op2, operand result);
-		operand bin_inst(string inst_name, operand op1, operand op2);
+		void bin_inst(ostream &o, const string &inst_name, const operand &op1, const operand &op2, const operand &result);
+		operand bin_inst(const string &inst_name, const operand &op1, const operand &op2);
 		// if an ostream is explicitly supplied, check it is compatible with constructor arguments.
 		void check_ostream(ostream& supplied) { assert (!stream || (stream == &supplied)); }
 		// if called without an explicitly supplied ostream,
@@ -33,105 +33,110 @@ class ValuePrinter {
 		ValuePrinter(ostream& o) : stream(&o) {}
 
 		/* Global constant initialization */
-		void init_constant(ostream &o, string name, const_value op);
-		void init_constant(string name, const_value op);
+		void init_constant(ostream &o, const string &name, const const_value &op);
+		void init_constant(const string &name, const const_value &op);
 		/* External constant declaration */
-		void init_ext_constant(ostream &o, string name, op_type type);
-		void init_ext_constant(string name, op_type type);
+		void init_ext_constant(ostream &o, const string &name, const op_type &type);
+		void init_ext_constant(const string &name, const op_type &type);
 		
 		/* Function definitions and declarations */
-		void declare(ostream &o, op_type ret_type, string name, vector<op_type> args);
-		void declare(op_type ret_type, string name, vector<op_type> args);
-		void define(ostream &o, op_type ret_type, string name, vector<operand> args);
-		void define(op_type ret_type, string name, vector<operand> args);
+		void declare(ostream &o, const op_type &ret_type, const string &name, const vector<op_type> &args);
+		void declare(const op_type &ret_type, const string &name, const vector<op_type> &args);
+		void define(ostream &o, const op_type &ret_type, const string &name, const vector<operand> &args);
+		void define(const op_type &ret_type, const string &name, const vector<operand> &args);
 		void end_define(ostream &o) { check_ostream(o); o << "}\n\n"; }
 		void end_define() { *stream << "}\n\n"; }
 
 		/* Type definition */
-		void type_define(ostream &o, string class_name, vector<op_type> attributes);
-		void type_define(string class_name, vector<op_type> attributes);
+		void type_define(ostream &o, const string &class_name, const vector<op_type> &attributes);
+		void type_define(const string &class_name, const vector<op_type> &attributes);
 
-		void type_alias_define(ostream &o, string alias_name, op_type type);
-		void type_alias_define(string alias_name, op_type type);
+		void type_alias_define(ostream &o, const string &alias_name, const op_type &type);
+		void type_alias_define(const string &alias_name, const op_type &type);
 
 		/* Structure constant definition */
-		void init_struct_constant(ostream &o, operand constant,
-			vector<op_type> field_types, vector<const_value> init_values);
-		void init_struct_constant(operand constant,
-			vector<op_type> field_types, vector<const_value> init_values);
+		void init_struct_constant(ostream &o, const operand &constant,
+			const vector<op_type> &field_types, const vector<const_value> &init_values);
+		void init_struct_constant(const operand &constant,
+			const vector<op_type> &field_types, const vector<const_value> &init_values);
 
 	/* Print a label */
-	void begin_block(string label);
+	void begin_block(const string &label);
 
 		/* Instruction Output methods are duplicated, once with the old signature taking
 		   an ostream and the result, and a new signature which does not
 		   take an ostream, and usually produces the result operand itself. */
 		/* Binary operations */
-		void add(ostream &o, operand op1, operand op2, operand result);	
-		void sub(ostream &o, operand op1, operand op2, operand result);	
-		void mul(ostream &o, operand op1, operand op2, operand result);	
-		void div(ostream &o, operand op1, operand op2, operand result);
-		void xor_in(ostream &o, operand op1, operand op2, operand result);
-
-		operand add(operand op1, operand op2);	
-		operand sub(operand op1, operand op2);	
-		operand mul(operand op1, operand op2);	
-		operand div(operand op1, operand op2);
-		operand xor_in(operand op1, operand op2);
+		void add(ostream &o, const operand &op1, const operand &op2, const operand &result);	
+		void sub(ostream &o, const operand &op1, const operand &op2, const operand &result);	
+		void mul(ostream &o, const operand &op1, const operand &op2, const operand &result);	
+		void div(ostream &o, const operand &op1, const operand &op2, const operand &result);
+		void xor_in(ostream &o, const operand &op1, const operand &op2, const operand &result);
+
+		operand add(const operand &op1, const operand &op2);	
+		operand sub(const operand &op1, const operand &op2);	
+		operand mul(const operand &op1, const operand &op2);	
+		operand div(const operand &op1, const operand &op2);
+		operand xor_in(const operand &op1, const operand &op2);
 
 		/* Memory access instructions */
-		void malloc_mem(ostream &o, int size, operand result);
-		void malloc_mem(ostream &o, operand size, operand result);
-		void alloca_mem(ostream &o, op_type type, operand op2);
-		void load(ostream &o, op_type type, operand op, operand op2);
-		void store(ostream &o, operand op, operand op2);
-		void getelementptr(ostream &o, op_type type, operand op1, operand op2, operand result);
-		void getelementptr(ostream &o, op_type type, operand op1, operand op2, operand op3, operand result);
-		void getelementptr(ostream &o, op_type type, operand op1, operand op2, operand op3, operand op4, operand result);
-		void getelementptr(ostream &o, op_type type, operand op1, operand op2, operand op3, operand op4, operand op5, operand result);
-		void getelementptr(ostream &o, op_type type, vector<operand> op, operand result);
+		void malloc_mem(ostream &o, int size, const operand &result);
+		void malloc_mem(ostream &o, const operand &size, const operand &result);
+		void alloca_mem(ostream &o, const op_type &type, const operand &op2);
+		void load(ostream &o, const op_type &type, const operand &op, const operand &op2);
+		void store(ostream &o, const operand &op, const operand &op2);
+		void getelementptr(ostream &o, const op_type &type, const operand &op1, const operand &op2, const operand &result);
+		void getelementptr(ostream &o, const op_type &type, const operand &op1, const operand &op2, const operand &op3, const operand &result);
+		void getelementptr(ostream &o, const op_type &type, const operand &op1, const operand &op2, const operand &op3, const operand &op4, const operand &result);
+		void getelementptr(ostream &o, const op_type &type, const operand &op1, const operand &op2, const operand &op3, const operand &op4, const operand &op5, const operand &result);
+		void getelementptr(ostream &o, const op_type &type, const vector<operand> &op, const operand &result);
 
 		operand malloc_mem(int size);
-		operand malloc_mem(operand size);
-		operand alloca_mem(op_type type);
-		operand load(op_type type, operand op);
+		operand malloc_mem(const operand &size);
+		operand alloca_mem(const op_type &type);
+		operand load(const op_type &type, const operand &op);
 
 		/* store does not produce a result */
-		void store(operand op, operand op2);
+		void store(const operand &op, const operand &op2);
 
 		/* getelementptr continues to requre an argument for the result type,
 		   becuase it is difficult to compute. */
-		operand getelementptr(op_type type, operand op1, operand op2, op_type result_type);
-		operand getelementptr(op_type type, operand op1, operand op2, operand op3, op_type result_type);
-		operand getelementptr(op_type type, operand op1, operand op2, operand op3, operand op4, op_type result_type);
-		operand getelementptr(op_type type, operand op1, operand op2, operand op3, operand op4, operand op5, op_type result_type);
-		operand getelementptr(op_type type, vector<operand> op, op_type result_type);
+		operand getelementptr(const op_type &type, const operand &op1, const operand &op2, const op_type &result_type);
+		operand getelementptr(const op_type &type, const operand &op1, const operand &op2, const operand &op3, const op_type &result_type);
+		operand getelementptr(const op_type &type, const operand &op1, const operand &op2, const operand &op3, const operand &op4, const op_type &result_type);
+		operand getelementptr(const op_type &type, const operand &op1, const operand &op2, const operand &op3, const operand &op4, const operand &op5, const op_type &result_type);
+		operand getelementptr(const op_type &type, const vector<operand> &op, const op_type &result_type);
 
 		/* Terminator instructions */
-		void branch_cond(ostream &o, operand op, label label_true, label label_false);
-		void branch_uncond(ostream &o, string label);
-		void ret(ostream &o, operand op);
+		void branch_cond(ostream &o, const operand &op, const label &label_true, const label &label_false);
+		void branch_uncond(ostream &o, const string &label);
+		void ret(ostream &o, const operand &op);
 		void unreachable(ostream &o) { check_ostream(o); o << "\tunreachable\n"; }
 
-		void branch_cond(operand op, label label_true, label label_false);
-		void branch_uncond(string label);
-		void ret(operand op);
+		void branch_cond(const operand &op, const label &label_true, const label &label_false);
+		void branch_uncond(const string &label);
+		void ret(const operand &op);
 		void unreachable() { unreachable(*stream); }
 
 		/* Other operations */		
-		void select(ostream &o, operand op1, operand op2, operand op3, operand result);
-		void icmp(ostream &o, icmp_val v, operand op1, operand op2, operand result);
-		void call(ostream &o, vector<op_type> arg_types, string fn_name,
-			bool is_global, vector<operand> args, operand result);
-		void bitcast(ostream &o, operand op, op_type new_type, operand result);
-		void ptrtoint(ostream &o, operand op, op_type new_type, operand result);
-
-		operand select(operand op1, operand op2, operand op3);
-		operand icmp(icmp_val v, operand op1, operand op2);
-		operand call(vector<op_type> arg_types, op_type result_type,
-			string fn_name, bool is_global, vector<operand> args);
-		operand bitcast(operand op, op_type new_type);
-		operand ptrtoint(operand op, op_type new_type);
+		void select(ostream &o, const operand &op1, const operand &op2, const operand &op3, const operand &result);
+		void icmp(ostream &o, icmp_val v, const operand &op1, const operand &op2, const operand &result);
+		void call(ostream &o, const vector<op_type> &arg_types, const string &fn_name,
+			bool is_global, const vector<operand> &args, const operand &result);
+		void bitcast(ostream &o, const operand &op, const op_type &new_type, const operand &result);
+		void ptrtoint(ostream &o, const operand &op, const op_type &new_type, const operand &result);
+
+		operand select(const operand &op1, const operand &op2, const operand &op3);
+		operand icmp(icmp_val v, const operand &op1, const operand &op2);
+		operand call(const vector<op_type> &arg_types, const op_type &result_type,
+			const string &fn_name, bool is_global, const vector<operand> &args);
+		operand bitcast(const operand &op, const op_type &new_type);
+		operand ptrtoint(const operand &op, const op_type &new_type);
+
+		/* The number of the next fresh temporary (%vtpm.n).  Code that cgen
+		   copies from its class cache moves it past the temporaries used. */
+		static int fresh_count();
+		static void set_fresh_count(int n);
 };
 
 #endif